@@ -0,0 +1,195 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../data.h"
+#include "account_refresh.h"
+#include "core/logging.hpp"
+#include "network/http_bench.h"
+#include "system/task.h"
+
+// Per-frame account list work on a synthetic 10k-account list: the launch
+// filter and the per-row status/colour/user ID formatting the accounts table
+// does. Runs once on the string-keyed record the app used to keep and once
+// on the compact AccountData, so the two can be compared side by side.
+namespace AccountBench {
+	// Record layout from before statuses were enums.
+	struct LegacyAccount {
+		int id = 0;
+		std::string displayName;
+		std::string username;
+		std::string userId;
+		std::string status;
+		std::string voiceStatus;
+		time_t voiceBanExpiry = 0;
+		time_t banExpiry = 0;
+		std::string note;
+		std::string cookie;
+		bool isFavorite = false;
+	};
+
+	// getStatusColor as it was: takes the string by value, compares in turn.
+	inline ImVec4 legacyStatusColor(std::string statusCode) {
+		if (statusCode == "Online")
+			return ImVec4(0.6f, 0.8f, 0.95f, 1.0f);
+		if (statusCode == "InGame")
+			return ImVec4(0.6f, 0.9f, 0.7f, 1.0f);
+		if (statusCode == "InStudio")
+			return ImVec4(1.0f, 0.85f, 0.7f, 1.0f);
+		if (statusCode == "Invisible")
+			return ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+		if (statusCode == "Banned")
+			return ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+		if (statusCode == "Terminated")
+			return ImVec4(0.8f, 0.1f, 0.1f, 1.0f);
+		return ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+	}
+
+	inline AccountList makeAccounts(size_t count) {
+		static constexpr AccountStatus kStatuses[] = {
+			AccountStatus::Offline, AccountStatus::Online, AccountStatus::InGame, AccountStatus::Offline,
+			AccountStatus::InStudio, AccountStatus::Invisible, AccountStatus::Banned, AccountStatus::Terminated,
+		};
+		static constexpr VoiceStatus kVoice[] = {VoiceStatus::Enabled, VoiceStatus::Disabled, VoiceStatus::Banned};
+		AccountList accounts(count);
+		for (size_t i = 0; i < count; ++i) {
+			auto &a = accounts[i];
+			a.id = static_cast<int>(i + 1);
+			a.userId = 1000000000ULL + i * 7919;
+			a.status = kStatuses[i % std::size(kStatuses)];
+			a.voiceStatus = kVoice[i % std::size(kVoice)];
+			a.username = "bench_user_" + std::to_string(i);
+			a.displayName = "Bench " + std::to_string(i);
+			a.note = "synthetic account for the list benchmark";
+			a.cookie = std::string(600, 'x'); // real cookies are roughly this long
+		}
+		return accounts;
+	}
+
+	inline std::vector<LegacyAccount> toLegacy(const AccountList &accounts) {
+		std::vector<LegacyAccount> out;
+		out.reserve(accounts.size());
+		for (const auto &a: accounts) {
+			LegacyAccount l;
+			l.id = a.id;
+			l.displayName = a.displayName;
+			l.username = a.username;
+			l.userId = std::to_string(a.userId);
+			l.status = toString(a.status);
+			l.voiceStatus = toString(a.voiceStatus);
+			l.note = a.note;
+			l.cookie = a.cookie;
+			out.push_back(std::move(l));
+		}
+		return out;
+	}
+
+	// Best-of-`passes` time for one pass of `work`, in nanoseconds per account.
+	template<typename Work>
+	double nsPerAccount(size_t accounts, int passes, Work &&work) {
+		double best = 0;
+		for (int p = 0; p < passes; ++p) {
+			auto t0 = std::chrono::steady_clock::now();
+			work();
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+			if (p == 0 || ns < best)
+				best = ns;
+		}
+		return best / static_cast<double>(accounts);
+	}
+
+	inline void RunAccountList(size_t count = 10000, int passes = 20) {
+		AccountList compact = makeAccounts(count);
+		std::vector<LegacyAccount> legacy = toLegacy(compact);
+		volatile size_t sink = 0;
+
+		double legacyFilter = nsPerAccount(count, passes, [&] {
+			size_t usable = 0;
+			for (const auto &a: legacy) {
+				if (!a.cookie.empty() && a.status != "Banned" && a.status != "Terminated")
+					++usable;
+			}
+			sink = usable;
+		});
+		double compactFilter = nsPerAccount(count, passes, [&] {
+			size_t usable = 0;
+			for (const auto &a: compact) {
+				if (!a.cookie.empty() && !isRestricted(a.status))
+					++usable;
+			}
+			sink = usable;
+		});
+
+		// What a table row computes before handing text to ImGui.
+		double legacyRows = nsPerAccount(count, passes, [&] {
+			float acc = 0;
+			for (const auto &a: legacy) {
+				ImVec4 c = legacyStatusColor(a.status);
+				const char *uid = a.userId.c_str();
+				bool banned = a.status == "Banned";
+				bool voiceBanned = a.voiceStatus == "Banned";
+				acc += c.x + (uid[0] != 0) + banned + voiceBanned + a.status.size();
+			}
+			sink = static_cast<size_t>(acc);
+		});
+		double compactRows = nsPerAccount(count, passes, [&] {
+			float acc = 0;
+			char uid[24];
+			for (const auto &a: compact) {
+				ImVec4 c = getStatusColor(a.status);
+				int len = snprintf(uid, sizeof(uid), "%llu", static_cast<unsigned long long>(a.userId));
+				bool banned = a.status == AccountStatus::Banned;
+				bool voiceBanned = a.voiceStatus == VoiceStatus::Banned;
+				acc += c.x + (len > 0) + banned + voiceBanned + (*toString(a.status) != 0);
+			}
+			sink = static_cast<size_t>(acc);
+		});
+
+		double legacyCopy = nsPerAccount(count, passes, [&] {
+			std::vector<LegacyAccount> copy = legacy;
+			sink = copy.size();
+		});
+		double compactCopy = nsPerAccount(count, passes, [&] {
+			AccountList copy = compact;
+			sink = copy.size();
+		});
+		(void) sink;
+
+		char buf[256];
+		snprintf(buf, sizeof(buf), "Account list benchmark: %zu accounts, best of %d; record %zu -> %zu bytes",
+		         count, passes, sizeof(LegacyAccount), sizeof(AccountData));
+		LOG_INFO(buf);
+		auto report = [&buf](const char *name, double before, double after) {
+			snprintf(buf, sizeof(buf), "Account list benchmark [%s]: %.1f -> %.1f ns/account (%.1fx)",
+			         name, before, after, after > 0 ? before / after : 0.0);
+			LOG_INFO(buf);
+		};
+		report("launch filter", legacyFilter, compactFilter);
+		report("table rows", legacyRows, compactRows);
+		report("snapshot copy", legacyCopy, compactCopy);
+	}
+
+	// One real refresh of every account with the process thread count
+	// sampled throughout. The cycle used to start 15 threads of its own (8
+	// moderation, 1 presence, 6 voice) and block each on its request; its
+	// per-account coroutines now only borrow pool workers between requests,
+	// so the peak should stay at the baseline.
+	inline void RunRefreshCycle() {
+		int baseline = HttpBench::processThreadCount();
+		AccountRefresh::CycleReport report;
+		HttpBench::Result r = HttpBench::measure([&report] {
+			report = AccountRefresh::RefreshAll();
+			return static_cast<int>(report.invalidIds.size());
+		});
+
+		char buf[256];
+		snprintf(buf, sizeof(buf), "Refresh benchmark: %zu accounts, %.1f ms wall, %d threads before, peak %d",
+		         report.accounts, r.wallMs, baseline, r.peakThreads);
+		LOG_INFO(buf);
+		LOG_INFO("Refresh benchmark: coroutines " + Async::describe());
+	}
+}
@@ -0,0 +1,437 @@
+#include "account_refresh.h"
+#include "account_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "core/logging.hpp"
+#include "system/main_thread.h"
+#include "system/task.h"
+#include "system/timers.h"
+
+using namespace std;
+
+namespace {
+	using Clock = chrono::steady_clock;
+
+	constexpr size_t kPresenceBatchSize = 100;
+	// How long the presence stage waits for more accounts before sending a
+	// partial batch.
+	constexpr auto kPresenceLinger = chrono::milliseconds(250);
+
+	mutex g_lastReportMutex;
+	optional<AccountRefresh::CycleReport> g_lastReport;
+
+	HttpClient::Request presenceBatchRequest(const vector<uint64_t> &ids, const string &cookie) {
+		nlohmann::json payload = {{"userIds", ids}};
+		return HttpClient::makePost(
+			Routes::url(Routes::Service::Presence, "/v1/presence/users"),
+			{{"Cookie", ".ROBLOSECURITY=" + cookie}},
+			payload.dump());
+	}
+
+	// userId -> presence for one batch; users the API left out are reported
+	// offline, like the single-user lookup does. Empty on failure.
+	optional<unordered_map<uint64_t, AccountStatus> > presenceStatuses(const HttpClient::Response &resp,
+	                                                            const vector<uint64_t> &ids) {
+		if (resp.status_code < 200 || resp.status_code >= 300) {
+			LOG_INFO("Presence batch failed: HTTP " + to_string(resp.status_code));
+			return nullopt;
+		}
+		auto presences = Roblox::presencesFromResponse(resp);
+		unordered_map<uint64_t, AccountStatus> out;
+		for (uint64_t uid: ids) {
+			auto it = presences.find(uid);
+			out[uid] = it == presences.end() ? AccountStatus::Offline : accountStatusFromString(it->second.presence);
+		}
+		return out;
+	}
+
+	// Keeps one stage's requests at most ratePerSecond apart, across all of
+	// its flows. Waits are timer-wheel sleeps, so to within a 50 ms tick.
+	class Pacer {
+	public:
+		explicit Pacer(double ratePerSecond)
+			: interval_(ratePerSecond > 0
+				            ? chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / ratePerSecond))
+				            : Clock::duration::zero()) {
+		}
+
+		// co_await wait() takes the next slot and sleeps until it comes up.
+		auto wait() {
+			if (interval_ == Clock::duration::zero())
+				return Async::sleepUntil(Clock::time_point{});
+			Clock::time_point slot;
+			{
+				lock_guard<mutex> lock(mtx_);
+				slot = max(Clock::now(), next_);
+				next_ = slot + interval_;
+			}
+			return Async::sleepUntil(slot);
+		}
+
+	private:
+		Clock::duration interval_;
+		mutex mtx_;
+		Clock::time_point next_{};
+	};
+
+	class StageMeter {
+	public:
+		StageMeter(string name, Clock::time_point cycleStart) : cycleStart_(cycleStart) { timing_.name = move(name); }
+
+		void record(Clock::time_point started, size_t items) {
+			auto now = Clock::now();
+			double ms = chrono::duration<double, milli>(now - started).count();
+			lock_guard<mutex> lock(mtx_);
+			timing_.items += items;
+			timing_.busyMs += ms;
+			timing_.maxMs = max(timing_.maxMs, ms);
+			timing_.doneAtMs = chrono::duration<double, milli>(now - cycleStart_).count();
+		}
+
+		AccountRefresh::StageTiming timing() {
+			lock_guard<mutex> lock(mtx_);
+			return timing_;
+		}
+
+	private:
+		Clock::time_point cycleStart_;
+		mutex mtx_;
+		AccountRefresh::StageTiming timing_;
+	};
+
+	struct Item {
+		AccountRefresh::AccountUpdate update;
+		string cookie;
+		uint64_t userId = 0;
+	};
+
+	// Gathers presence lookups from the account flows into batches of up to
+	// kPresenceBatchSize users. A batch goes out once it is full or
+	// kPresenceLinger after its first lookup, and each flow in it resumes
+	// with its own status (nullopt if the batch failed).
+	class PresenceBatcher : public enable_shared_from_this<PresenceBatcher> {
+	public:
+		PresenceBatcher(const AccountRefresh::StageOptions &options, StageMeter &meter)
+			: slots_(static_cast<size_t>(max(1, options.workers))), pacer_(options.ratePerSecond), meter_(meter) {
+		}
+
+		auto lookup(uint64_t userId, const string &cookie) {
+			struct Awaiter {
+				shared_ptr<PresenceBatcher> batcher;
+				uint64_t userId;
+				const string &cookie;
+				optional<AccountStatus> result;
+
+				bool await_ready() const noexcept { return false; }
+
+				void await_suspend(coroutine_handle<> h) {
+					batcher->add(Waiter{userId, &result, h, Async::Context::current()}, cookie);
+				}
+
+				optional<AccountStatus> await_resume() { return result; }
+			};
+			return Awaiter{shared_from_this(), userId, cookie, nullopt};
+		}
+
+	private:
+		struct Waiter {
+			uint64_t userId = 0;
+			optional<AccountStatus> *result = nullptr;
+			coroutine_handle<> h;
+			Async::Context ctx;
+		};
+
+		struct Batch {
+			vector<Waiter> waiters;
+			string cookie; // every account here just passed moderation, so any of them works
+		};
+
+		void add(Waiter w, const string &cookie) {
+			shared_ptr<Batch> full;
+			weak_ptr<Batch> opened;
+			{
+				lock_guard<mutex> lock(mtx_);
+				if (!open_) {
+					open_ = make_shared<Batch>();
+					open_->cookie = cookie;
+					opened = open_;
+				}
+				open_->waiters.push_back(move(w));
+				if (open_->waiters.size() >= kPresenceBatchSize)
+					full = move(open_);
+			}
+			if (full) {
+				send(move(full));
+			} else if (!opened.expired()) {
+				Timers::after("refresh.presence_linger", kPresenceLinger, [self = shared_from_this(), opened] {
+					shared_ptr<Batch> batch;
+					{
+						// Unless it already went out full.
+						lock_guard<mutex> lock(self->mtx_);
+						if (self->open_ && self->open_ == opened.lock())
+							batch = move(self->open_);
+					}
+					if (batch)
+						self->send(move(batch));
+				});
+			}
+		}
+
+		void send(shared_ptr<Batch> batch) {
+			Async::spawn("refresh.presence", Threading::Priority::Background, sendBatch(shared_from_this(), move(batch)));
+		}
+
+		static Async::Task<void> sendBatch(shared_ptr<PresenceBatcher> self, shared_ptr<Batch> batch) {
+			vector<uint64_t> ids;
+			for (const auto &w: batch->waiters) {
+				if (find(ids.begin(), ids.end(), w.userId) == ids.end())
+					ids.push_back(w.userId);
+			}
+
+			optional<unordered_map<uint64_t, AccountStatus> > statuses;
+			{
+				auto permit = co_await self->slots_.acquire();
+				co_await self->pacer_.wait();
+				auto started = Clock::now();
+				auto resp = co_await HttpClient::fetch(presenceBatchRequest(ids, batch->cookie));
+				statuses = presenceStatuses(resp, ids);
+				self->meter_.record(started, batch->waiters.size());
+			}
+
+			// The cycle can end as soon as the last flow resumes, so nothing
+			// of it is touched after this loop.
+			for (auto &w: batch->waiters) {
+				if (statuses)
+					*w.result = (*statuses)[w.userId];
+				Async::resumeOnPool("refresh.presence", w.h, move(w.ctx));
+			}
+		}
+
+		Async::Semaphore slots_;
+		Pacer pacer_;
+		StageMeter &meter_;
+		mutex mtx_;
+		shared_ptr<Batch> open_;
+	};
+
+	struct Cycle {
+		Cycle(const AccountRefresh::Options &options, Clock::time_point start, AccountRefresh::CycleReport &report,
+		      const AccountRefresh::UpdateFn &onUpdate)
+			: moderationMeter("moderation", start), presenceMeter("presence", start), voiceMeter("voice", start),
+			  moderationSlots(static_cast<size_t>(max(1, options.moderation.workers))),
+			  voiceSlots(static_cast<size_t>(max(1, options.voice.workers))),
+			  moderationPacer(options.moderation.ratePerSecond), voicePacer(options.voice.ratePerSecond),
+			  presence(make_shared<PresenceBatcher>(options.presence, presenceMeter)), report(report),
+			  onUpdate(onUpdate) {
+		}
+
+		StageMeter moderationMeter, presenceMeter, voiceMeter;
+		Async::Semaphore moderationSlots, voiceSlots;
+		Pacer moderationPacer, voicePacer;
+		shared_ptr<PresenceBatcher> presence;
+		mutex reportMutex;
+		AccountRefresh::CycleReport &report;
+		const AccountRefresh::UpdateFn &onUpdate;
+	};
+
+	// One account through moderation -> presence -> voice. Stage slots are
+	// held only around that stage's request, and the flow holds no thread
+	// while it waits for a slot, its pacer or the network.
+	Async::Task<void> refreshAccount(Cycle &cycle, Item item) {
+		HttpClient::Response response;
+		{
+			auto permit = co_await cycle.moderationSlots.acquire();
+			co_await cycle.moderationPacer.wait();
+			auto started = Clock::now();
+			response = co_await HttpClient::fetch(Roblox::banCheckRequest(item.cookie));
+			cycle.moderationMeter.record(started, 1);
+		}
+		item.update.ban = Roblox::banInfoFromResponse(response);
+		Roblox::rememberBanStatus(item.cookie, item.update.ban);
+
+		// Only the server refusing the cookie means it is bad; a transport
+		// failure, a 429 or a 5xx comes back as Unknown.
+		if (item.update.ban.status == Roblox::BanCheckResult::InvalidCookie) {
+			lock_guard<mutex> lock(cycle.reportMutex);
+			cycle.report.invalidIds.push_back(item.update.accountId);
+		}
+
+		if (item.update.ban.status == Roblox::BanCheckResult::Unbanned && item.userId != 0) {
+			item.update.presence = co_await cycle.presence->lookup(item.userId, item.cookie);
+
+			auto permit = co_await cycle.voiceSlots.acquire();
+			co_await cycle.voicePacer.wait();
+			auto started = Clock::now();
+			auto voice = co_await HttpClient::fetch(Roblox::voiceSettingsRequest(item.cookie));
+			item.update.voice = Roblox::voiceSettingsFromResponse(voice);
+			cycle.voiceMeter.record(started, 1);
+		}
+
+		if (cycle.onUpdate)
+			cycle.onUpdate(item.update);
+	}
+
+	Async::Task<void> refreshAll(vector<Async::Task<void> > flows) {
+		co_await Async::whenAll(move(flows));
+	}
+}
+
+namespace AccountRefresh {
+	CycleReport RunCycle(const vector<AccountData> &accounts, const Options &options, const UpdateFn &onUpdate) {
+		auto cycleStart = Clock::now();
+		CycleReport report;
+		Cycle cycle(options, cycleStart, report, onUpdate);
+
+		vector<Async::Task<void> > flows;
+		for (const auto &acct: accounts) {
+			if (acct.cookie.empty())
+				continue;
+			++report.accounts;
+			Item item;
+			item.update.accountId = acct.id;
+			item.cookie = acct.cookie;
+			item.userId = acct.userId;
+			flows.push_back(refreshAccount(cycle, move(item)));
+		}
+
+		// Every account is in flight at once, each only waiting for its
+		// stage slots; this thread helps out on the pool until they're done.
+		Async::wait("refresh.cycle", Threading::Priority::Background, refreshAll(move(flows)));
+
+		report.wallMs = chrono::duration<double, milli>(Clock::now() - cycleStart).count();
+		report.stages = {cycle.moderationMeter.timing(), cycle.presenceMeter.timing(), cycle.voiceMeter.timing()};
+		return report;
+	}
+
+	void ApplyTo(AccountData &acct, const AccountUpdate &update) {
+		switch (update.ban.status) {
+			case Roblox::BanCheckResult::Banned:
+				acct.status = AccountStatus::Banned;
+				acct.banExpiry = update.ban.endDate;
+				return;
+			case Roblox::BanCheckResult::Terminated:
+				acct.status = AccountStatus::Terminated;
+				acct.banExpiry = 0; // Terminated accounts don't have an end date
+				return;
+			case Roblox::BanCheckResult::InvalidCookie:
+			case Roblox::BanCheckResult::Unknown:
+				return;
+			case Roblox::BanCheckResult::Unbanned:
+				break;
+		}
+
+		acct.banExpiry = 0;
+		if (update.presence)
+			acct.status = *update.presence;
+		else if (isRestricted(acct.status))
+			acct.status = AccountStatus::Offline; // ban lifted, presence not known yet
+		if (update.voice) {
+			acct.voiceStatus = update.voice->status;
+			acct.voiceBanExpiry = update.voice->bannedUntil;
+		}
+	}
+
+	void Apply(const AccountUpdate &update) {
+		AccountStore::instance().enqueue([update](AccountList &accounts) {
+			auto it = find_if(accounts.begin(), accounts.end(),
+			                  [&](const AccountData &a) { return a.id == update.accountId; });
+			if (it == accounts.end())
+				return;
+			ApplyTo(*it, update);
+			if (isRestricted(it->status))
+				MainThread::Post([id = it->id] { g_selectedAccountIds.erase(id); });
+		});
+	}
+
+	CycleReport RefreshAccounts(const vector<int> &accountIds, const Options &options) {
+		AccountSnapshot accounts = AccountStore::instance().snapshot();
+		vector<AccountData> snapshot;
+		for (const auto &acct: *accounts) {
+			if (find(accountIds.begin(), accountIds.end(), acct.id) != accountIds.end())
+				snapshot.push_back(acct);
+		}
+
+		// Pick up renames in a few batched lookups. Cached per user ID, so
+		// most cycles don't send anything.
+		vector<uint64_t> userIds;
+		for (const auto &acct: snapshot)
+			userIds.push_back(acct.userId);
+		auto profiles = Roblox::resolveProfiles(userIds);
+		if (!profiles.empty()) {
+			AccountStore::instance().enqueue([profiles](AccountList &list) {
+				for (auto &acct: list) {
+					auto it = profiles.find(acct.userId);
+					if (it == profiles.end())
+						continue;
+					acct.username = it->second.username;
+					acct.displayName = it->second.displayName;
+				}
+			});
+		}
+
+		CycleReport report = RunCycle(snapshot, options, [&snapshot](const AccountUpdate &update) {
+			auto it = find_if(snapshot.begin(), snapshot.end(),
+			                  [&](const AccountData &a) { return a.id == update.accountId; });
+			if (it != snapshot.end()) {
+				AccountData after = *it;
+				ApplyTo(after, update);
+				Scheduler::instance().completed(*it, after);
+			}
+			Apply(update);
+		});
+		// Whatever the UI hasn't committed yet goes in now, so the save sees all of it.
+		AccountStore::instance().commit();
+		Data::SaveAccounts();
+
+		for (const auto &acct: snapshot) {
+			auto it = find(report.invalidIds.begin(), report.invalidIds.end(), acct.id);
+			if (it == report.invalidIds.end())
+				continue;
+			if (!report.invalidNames.empty())
+				report.invalidNames += ", ";
+			report.invalidNames += acct.displayName.empty() ? acct.username : acct.displayName;
+		}
+
+		LOG_INFO(Describe(report));
+		{
+			lock_guard<mutex> lock(g_lastReportMutex);
+			g_lastReport = report;
+		}
+		return report;
+	}
+
+	CycleReport RefreshAll(const Options &options) {
+		vector<int> ids;
+		for (const auto &acct: *AccountStore::instance().snapshot())
+			ids.push_back(acct.id);
+		return RefreshAccounts(ids, options);
+	}
+
+	string Describe(const CycleReport &report) {
+		char buf[128];
+		snprintf(buf, sizeof(buf), "Account refresh: %zu accounts in %.0f ms", report.accounts, report.wallMs);
+		string out = buf;
+		for (const auto &s: report.stages) {
+			snprintf(buf, sizeof(buf), "; %s %zu in %.0f ms busy (max %.0f, done at %.0f)",
+			         s.name.c_str(), s.items, s.busyMs, s.maxMs, s.doneAtMs);
+			out += buf;
+		}
+		return out;
+	}
+
+	optional<CycleReport> LastReport() {
+		lock_guard<mutex> lock(g_lastReportMutex);
+		return g_lastReport;
+	}
+}
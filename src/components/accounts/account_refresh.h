@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../data.h"
+#include "network/roblox.h"
+
+namespace AccountRefresh {
+	struct StageOptions {
+		int workers = 1;          // requests the stage may have in flight at once
+		double ratePerSecond = 0; // 0 = only the per-host HTTP limiter applies
+	};
+
+	struct Options {
+		StageOptions moderation{8, 10};
+		StageOptions presence{1, 2};  // each item is a batch of up to 100 accounts
+		StageOptions voice{6, 8};
+	};
+
+	// What a cycle learned about one account. Fields stay empty for stages
+	// the account didn't reach (banned accounts stop after moderation).
+	struct AccountUpdate {
+		int accountId = 0;
+		Roblox::BanInfo ban;
+		std::optional<AccountStatus> presence;
+		std::optional<Roblox::VoiceSettings> voice;
+	};
+
+	struct StageTiming {
+		std::string name;
+		size_t items = 0;
+		double busyMs = 0;   // summed across workers
+		double maxMs = 0;    // slowest single item
+		double doneAtMs = 0; // since cycle start
+	};
+
+	struct CycleReport {
+		size_t accounts = 0;
+		double wallMs = 0;
+		std::vector<StageTiming> stages;
+		std::vector<int> invalidIds;
+		std::string invalidNames;
+	};
+
+	using UpdateFn = std::function<void(const AccountUpdate &)>;
+
+	// Moderation -> presence -> voice as a pipeline: each account is a
+	// coroutine, each stage has its own concurrency and request budget, and
+	// accounts move on as soon as their previous stage is done. No thread is
+	// held while a request is out. onUpdate fires once per account, from a
+	// pool worker, as soon as that account is finished. Blocks the caller.
+	CycleReport RunCycle(const std::vector<AccountData> &accounts, const Options &options, const UpdateFn &onUpdate);
+
+	// Writes an update into one account record.
+	void ApplyTo(AccountData &acct, const AccountUpdate &update);
+
+	// Queues an update for the AccountStore's next commit. Any thread.
+	void Apply(const AccountUpdate &update);
+
+	// Runs a cycle over the given accounts, streaming results into the
+	// AccountStore as they finish and saving once everything has landed. Each
+	// finished account is handed back to the Scheduler.
+	CycleReport RefreshAccounts(const std::vector<int> &accountIds, const Options &options = Options{});
+
+	CycleReport RefreshAll(const Options &options = Options{});
+
+	std::string Describe(const CycleReport &report);
+
+	// Most recent finished cycle, for diagnostics.
+	std::optional<CycleReport> LastReport();
+}
@@ -0,0 +1,197 @@
+#include "account_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <unordered_set>
+
+#include "core/logging.hpp"
+
+using namespace std;
+
+namespace {
+	using Clock = AccountRefresh::Scheduler::Clock;
+
+	// Accounts due this close together are refreshed in one cycle.
+	constexpr auto kBatchWindow = chrono::seconds(5);
+	// Wake up at least this often to pick up added or removed accounts.
+	constexpr auto kResyncEvery = chrono::seconds(30);
+	constexpr auto kMinInterval = chrono::seconds(15);
+	// Give the server a moment to lift a ban before looking again.
+	constexpr auto kExpirySlack = chrono::seconds(30);
+	// An account whose refresh never reported back is tried again after this.
+	constexpr auto kRetryUnreported = chrono::minutes(1);
+
+	Clock::duration untilExpiry(time_t expiry, time_t now) {
+		return chrono::seconds(expiry - now) + kExpirySlack;
+	}
+}
+
+namespace AccountRefresh {
+	Scheduler::Clock::duration Scheduler::intervalFor(const AccountData &acct, int unchangedRefreshes, time_t now) {
+		const Clock::duration base = chrono::minutes(max(1, g_statusRefreshInterval));
+		Clock::duration interval;
+
+		switch (acct.status) {
+			case AccountStatus::InGame:
+			case AccountStatus::InStudio:
+			case AccountStatus::Online:
+				interval = base;
+				break;
+			case AccountStatus::Terminated:
+				interval = chrono::hours(12);
+				break;
+			case AccountStatus::Banned:
+				interval = acct.banExpiry > now
+					           ? min<Clock::duration>(untilExpiry(acct.banExpiry, now), chrono::hours(6))
+					           : chrono::hours(1);
+				break;
+			case AccountStatus::Offline:
+			case AccountStatus::Invisible:
+				// 5x base, doubling for every refresh that found nothing new, up to an hour's worth.
+				interval = min<Clock::duration>(base * 5 * (1 << min(unchangedRefreshes, 4)), base * 60);
+				break;
+			default:
+				interval = base * 5;
+				break;
+		}
+
+		if (acct.voiceStatus == VoiceStatus::Banned && acct.voiceBanExpiry > now)
+			interval = min(interval, untilExpiry(acct.voiceBanExpiry, now));
+
+		return max<Clock::duration>(interval, kMinInterval);
+	}
+
+	void Scheduler::start(RefreshFn refresh) {
+		lock_guard<mutex> lock(mtx_);
+		refresh_ = move(refresh);
+		armLocked(Clock::now());
+	}
+
+	void Scheduler::fire(uint64_t generation) {
+		{
+			lock_guard<mutex> lock(mtx_);
+			if (generation != generation_)
+				return;
+			if (running_) {
+				rerun_ = true;
+				return;
+			}
+			running_ = true;
+			timer_ = 0;
+		}
+
+		auto due = takeDue(*AccountStore::instance().snapshot());
+		if (!due.empty()) {
+			try {
+				refresh_(due);
+			} catch (const exception &e) {
+				LOG_ERROR(string("Account refresh failed: ") + e.what());
+			} catch (...) {
+				LOG_ERROR("Account refresh failed");
+			}
+			unpark(due);
+		}
+
+		lock_guard<mutex> lock(mtx_);
+		running_ = false;
+		auto next = Clock::now() + kResyncEvery;
+		if (rerun_)
+			next = Clock::now();
+		else if (!heap_.empty())
+			next = min(next, heap_.top().at);
+		rerun_ = false;
+		armLocked(next);
+	}
+
+	void Scheduler::armLocked(Clock::time_point at) {
+		Timers::cancel(timer_);
+		uint64_t generation = ++generation_;
+		timer_ = Timers::at("accounts.refresh", at, [this, generation] { fire(generation); });
+	}
+
+	vector<int> Scheduler::takeDue(const vector<AccountData> &accounts) {
+		lock_guard<mutex> lock(mtx_);
+
+		unordered_set<int> present;
+		for (const auto &acct: accounts) {
+			if (acct.cookie.empty())
+				continue;
+			present.insert(acct.id);
+			if (!state_.count(acct.id))
+				scheduleLocked(acct.id, Clock::now());
+		}
+		for (auto it = state_.begin(); it != state_.end();) {
+			if (present.count(it->first))
+				++it;
+			else
+				it = state_.erase(it);
+		}
+
+		vector<int> due;
+		auto horizon = Clock::now() + kBatchWindow;
+		while (!heap_.empty() && heap_.top().at <= horizon) {
+			Due d = heap_.top();
+			heap_.pop();
+			auto it = state_.find(d.accountId);
+			if (it == state_.end() || it->second.due != d.at)
+				continue; // stale entry
+			// Parked far out until the refresh reports back.
+			it->second.due = Clock::time_point::max();
+			due.push_back(d.accountId);
+		}
+		return due;
+	}
+
+	void Scheduler::completed(const AccountData &before, const AccountData &after) {
+		lock_guard<mutex> lock(mtx_);
+		auto it = state_.find(after.id);
+		if (it == state_.end())
+			return;
+		bool unchanged = before.status == after.status && before.voiceStatus == after.voiceStatus;
+		it->second.unchangedRefreshes = unchanged ? it->second.unchangedRefreshes + 1 : 0;
+		scheduleLocked(after.id, Clock::now() + intervalFor(after, it->second.unchangedRefreshes, time(nullptr)));
+	}
+
+	void Scheduler::unpark(const vector<int> &accountIds) {
+		lock_guard<mutex> lock(mtx_);
+		auto retryAt = Clock::now() + kRetryUnreported;
+		for (int id: accountIds) {
+			auto it = state_.find(id);
+			if (it != state_.end() && it->second.due == Clock::time_point::max())
+				scheduleLocked(id, retryAt);
+		}
+	}
+
+	void Scheduler::refreshAllNow() {
+		lock_guard<mutex> lock(mtx_);
+		auto now = Clock::now();
+		for (auto &[id, state]: state_) {
+			state.unchangedRefreshes = 0;
+			scheduleLocked(id, now);
+		}
+		if (running_)
+			rerun_ = true;
+		else if (refresh_)
+			armLocked(now);
+	}
+
+	size_t Scheduler::tracked() const {
+		lock_guard<mutex> lock(mtx_);
+		return state_.size();
+	}
+
+	double Scheduler::secondsUntilNext() const {
+		lock_guard<mutex> lock(mtx_);
+		auto next = Clock::time_point::max();
+		for (const auto &[id, state]: state_)
+			next = min(next, state.due);
+		if (next == Clock::time_point::max())
+			return -1;
+		return max(0.0, chrono::duration<double>(next - Clock::now()).count());
+	}
+
+	void Scheduler::scheduleLocked(int accountId, Clock::time_point at) {
+		state_[accountId].due = at;
+		heap_.push({at, accountId});
+	}
+}
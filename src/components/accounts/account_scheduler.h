@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../data.h"
+#include "system/timers.h"
+
+namespace AccountRefresh {
+	// Decides when each account is next refreshed. Accounts that are in a
+	// game or online are checked every g_statusRefreshInterval; offline ones
+	// back off the longer they stay unchanged; bans are rechecked around
+	// their expiry; terminated accounts hardly ever. Due times live in a
+	// min-heap, and a single timer is kept armed for the soonest one.
+	class Scheduler {
+	public:
+		using Clock = std::chrono::steady_clock;
+		using RefreshFn = std::function<void(const std::vector<int> &accountIds)>;
+
+		static Scheduler &instance() {
+			static Scheduler scheduler;
+			return scheduler;
+		}
+
+		// Arms the refresh timer. Whenever accounts come due (and at least
+		// every 30 s, to pick up added or removed ones) `refresh` is called
+		// on a pool worker with everything due within the next few seconds,
+		// so they share a cycle. Calls never overlap.
+		void start(RefreshFn refresh);
+
+		// Reschedules an account from its state after a refresh.
+		void completed(const AccountData &before, const AccountData &after);
+
+		// Makes every account due now (Accounts > Refresh Statuses).
+		void refreshAllNow();
+
+		size_t tracked() const;
+
+		// Seconds until the soonest due account, or -1 if none are tracked.
+		double secondsUntilNext() const;
+
+		// Interval for an account in the given state; exposed for the log line.
+		static Clock::duration intervalFor(const AccountData &acct, int unchangedRefreshes, std::time_t now);
+
+	private:
+		struct Due {
+			Clock::time_point at;
+			int accountId;
+
+			bool operator>(const Due &o) const { return at > o.at; }
+		};
+
+		struct State {
+			Clock::time_point due;
+			int unchangedRefreshes = 0;
+		};
+
+		// Accounts not seen before are due immediately; ones no longer in
+		// `accounts` are dropped.
+		std::vector<int> takeDue(const std::vector<AccountData> &accounts);
+
+		void fire(uint64_t generation);
+
+		// Reschedules accounts from `accountIds` that are still parked after
+		// their cycle, i.e. the refresh threw or never reported back on them;
+		// otherwise they would never come due again.
+		void unpark(const std::vector<int> &accountIds);
+
+		void armLocked(Clock::time_point at);
+
+		void scheduleLocked(int accountId, Clock::time_point at);
+
+		mutable std::mutex mtx_;
+		// Entries whose time no longer matches state_ are stale and skipped.
+		std::priority_queue<Due, std::vector<Due>, std::greater<Due> > heap_;
+		std::unordered_map<int, State> state_;
+		RefreshFn refresh_;
+		Timers::Id timer_ = 0;
+		uint64_t generation_ = 0; // bumped on every arm; older timers that still fire are ignored
+		bool running_ = false;
+		bool rerun_ = false; // refreshAllNow() arrived mid-cycle
+	};
+}
@@ -56,11 +56,11 @@ void LaunchBrowserWithCookie(const AccountData &account) {
 
     LOG_INFO("Launching WebView2 browser for account: " + account.displayName);
 
-    LaunchWebview("https://www.roblox.com/home", account.username + " - " + account.userId,
+    LaunchWebview("https://www.roblox.com/home", account.username + " - " + to_string(account.userId),
                   account.cookie);
 }
 
-void RenderAccountContextMenu(AccountData &account, const string &unique_context_menu_id) {
+void RenderAccountContextMenu(const AccountData &account, const string &unique_context_menu_id) {
     if (!IsPopupOpen(unique_context_menu_id.c_str()))
         g_cachedGameInfo.erase(account.id);
 
@@ -68,10 +68,10 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
         if (IsWindowAppearing()) {
             // Refresh cached game data when the menu is opened
             g_cachedGameInfo.erase(account.id);
-            if (account.status == "InGame") {
+            if (account.status == AccountStatus::InGame) {
                 try {
-                    auto pres = Roblox::getPresences({stoull(account.userId)}, account.cookie);
-                    auto itp = pres.find(stoull(account.userId));
+                    auto pres = Roblox::getPresences({account.userId}, account.cookie);
+                    auto itp = pres.find(account.userId);
                     if (itp != pres.end()) {
                         g_cachedGameInfo[account.id] = {itp->second.placeId, itp->second.gameId};
                     }
@@ -101,10 +101,11 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
 
             if (Button("Save##Note")) {
                 if (g_editing_note_for_account_id_ctx == account.id) {
-                    account.note = g_edit_note_buffer_ctx;
+                    string note = g_edit_note_buffer_ctx;
+                    AccountStore::instance().update(account.id, [&](AccountData &acct) { acct.note = note; });
                     Data::SaveAccounts();
-                    printf("Note updated for account ID %d: %s\n", account.id, account.note.c_str());
-                    LOG_INFO("Note updated for account ID " + to_string(account.id) + ": " + account.note);
+                    printf("Note updated for account ID %d: %s\n", account.id, note.c_str());
+                    LOG_INFO("Note updated for account ID " + to_string(account.id) + ": " + note);
                 }
                 g_editing_note_for_account_id_ctx = -1;
                 CloseCurrentPopup();
@@ -120,7 +121,7 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
         Separator();
 
 
-        if (account.status == "InGame") {
+        if (account.status == AccountStatus::InGame) {
             uint64_t placeId = 0;
             string jobId;
             auto itCache = g_cachedGameInfo.find(account.id);
@@ -158,12 +159,12 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
         if (BeginMenu("Open In Browser")) {
             if (MenuItem("Home Page")) {
                 if (!account.cookie.empty())
-                    LaunchWebview("https://www.roblox.com/home", account.username + " - " + account.userId,
+                    LaunchWebview("https://www.roblox.com/home", account.username + " - " + to_string(account.userId),
                                   account.cookie);
             }
             if (MenuItem("Profile")) {
                 if (!account.cookie.empty())
-                    LaunchWebview("https://www.roblox.com/users/" + account.userId + "/profile", account.username,
+                    LaunchWebview("https://www.roblox.com/users/" + to_string(account.userId) + "/profile", account.username,
                                   account.cookie);
             }
             if (MenuItem("Avatar")) {
@@ -199,7 +200,8 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
             string place_id_str = join_value_buf;
             string job_id_str = join_jobid_buf;
 
-            Threading::newThread(
+            Threading::interactive(
+                "accounts.launch_link",
                 [acc_cookie, place_id_str, job_id_str, account_id = account.id, account_display_name = account.
                     displayName] {
                     LOG_INFO(
@@ -247,7 +249,7 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
         Separator();
 
         if (MenuItem("Copy UserID")) {
-            SetClipboardText(account.userId.c_str());
+            SetClipboardText(to_string(account.userId).c_str());
             LOG_INFO("Copied UserID for account: " + account.displayName);
         }
         if (MenuItem("Copy Cookie")) {
@@ -283,11 +285,13 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
             snprintf(buf, sizeof(buf), "Delete %s?", account.displayName.c_str());
             ConfirmPopup::Add(buf, [id = account.id, displayName = account.displayName]() {
                 LOG_INFO("Attempting to delete account: " + displayName + " (ID: " + to_string(id) + ")");
-                erase_if(
-                    g_accounts,
-                    [&](const AccountData &acc_data) {
-                        return acc_data.id == id;
-                    });
+                AccountStore::instance().modify([&](AccountList &accounts) {
+                    erase_if(
+                        accounts,
+                        [&](const AccountData &acc_data) {
+                            return acc_data.id == id;
+                        });
+                });
                 g_selectedAccountIds.erase(id);
                 Status::Set("Deleted account " + displayName);
                 Data::SaveAccounts();
@@ -304,11 +308,13 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
             if (MenuItem(buf)) {
                 ConfirmPopup::Add("Delete selected accounts?", []() {
                     LOG_INFO("Attempting to delete " + to_string(g_selectedAccountIds.size()) + " selected accounts.");
-                    erase_if(
-                        g_accounts,
-                        [&](const AccountData &acc_data) {
-                            return g_selectedAccountIds.contains(acc_data.id);
-                        });
+                    AccountStore::instance().modify([](AccountList &accounts) {
+                        erase_if(
+                            accounts,
+                            [&](const AccountData &acc_data) {
+                                return g_selectedAccountIds.contains(acc_data.id);
+                            });
+                    });
                     g_selectedAccountIds.clear();
                     Data::SaveAccounts();
                     Status::Set("Deleted selected accounts");
@@ -338,7 +344,7 @@ void RenderAccountContextMenu(AccountData &account, const string &unique_context
         PopItemWidth();
         Spacing();
         if (Button("Open", ImVec2(openWidth, 0)) && g_customUrlBuffer[0] != '\0') {
-            LaunchWebview(g_customUrlBuffer, account.username + " - " + account.userId, account.cookie);
+            LaunchWebview(g_customUrlBuffer, account.username + " - " + to_string(account.userId), account.cookie);
             g_customUrlBuffer[0] = '\0';
             CloseCurrentPopup();
         }
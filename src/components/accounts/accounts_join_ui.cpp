@@ -87,7 +87,22 @@ void RenderJoinOptions() {
     }
 
     Separator();
-    if (Button(" \xEF\x8B\xB6  Join ")) {
+    bool joinClicked = Button(" \xEF\x8B\xB6  Join ");
+
+    // Reaching for Join means a launch is coming; have tickets ready for it.
+    static bool joinHovered = false;
+    if (IsItemHovered() && !joinHovered) {
+        vector<string> cookies;
+        for (int id: g_selectedAccountIds) {
+            auto acct = AccountStore::instance().find(id);
+            if (acct && !isRestricted(acct->status))
+                cookies.push_back(acct->cookie);
+        }
+        Roblox::TicketBuffer::instance().prefetch(cookies);
+    }
+    joinHovered = IsItemHovered();
+
+    if (joinClicked) {
         auto doJoin = [&]() {
             if (g_selectedAccountIds.empty()) {
                 ModalPopup::Add("Select an account first.");
@@ -98,15 +113,13 @@ void RenderJoinOptions() {
                 string username = join_value_buf;
                 vector<pair<int, string> > accounts;
                 for (int id: g_selectedAccountIds) {
-                    auto it = std::find_if(g_accounts.begin(), g_accounts.end(),
-                                           [id](auto &a) { return a.id == id; });
-                    if (it != g_accounts.end())
-                        accounts.emplace_back(it->id, it->cookie);
+                    if (auto acct = AccountStore::instance().find(id))
+                        accounts.emplace_back(acct->id, acct->cookie);
                 }
                 if (accounts.empty())
                     return;
 
-                Threading::newThread([username, accounts]() {
+                Threading::interactive("launch.follow_user", [username, accounts]() {
                     try {
                         uint64_t uid = Roblox::getUserIdFromUsername(username);
                         auto pres = Roblox::getPresences({uid}, accounts.front().second);
@@ -148,15 +161,12 @@ void RenderJoinOptions() {
 
             std::vector<std::pair<int, std::string> > accounts;
             for (int id: g_selectedAccountIds) {
-                auto it = std::find_if(g_accounts.begin(), g_accounts.end(),
-                                       [id](auto &a) { return a.id == id; });
-                if (it != g_accounts.end() && it->status != "Banned" && it->status != "Terminated")
-                    accounts.emplace_back(it->id, it->cookie);
+                auto acct = AccountStore::instance().find(id);
+                if (acct && !isRestricted(acct->status))
+                    accounts.emplace_back(acct->id, acct->cookie);
             }
 
-            Threading::newThread([placeId_val, jobId_str, accounts]() {
-                launchRobloxSequential(placeId_val, jobId_str, accounts);
-            });
+            launchRobloxSequential(placeId_val, jobId_str, accounts);
         };
 #ifdef _WIN32
         if (!g_multiRobloxEnabled && RobloxControl::IsRobloxRunning()) {
@@ -33,7 +33,7 @@ static int s_urlPopupAccountId = -1;
 static char s_urlBuffer[256] = "";
 static std::unordered_set<int> s_voiceUpdateInProgress;
 
-void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *table_id, float table_height)
+void RenderAccountsTable(const vector<AccountData> &accounts_to_display, const char *table_id, float table_height)
 {
 	constexpr int column_count = 6;
 	ImGuiTableFlags table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
@@ -97,7 +97,7 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 			char selectable_label[64];
 			snprintf(selectable_label, sizeof(selectable_label), "##row_selectable_%d", account.id);
 
-			bool banned = account.status == "Banned";
+			bool banned = account.status == AccountStatus::Banned;
 			if (Selectable(
 					selectable_label,
 					is_row_selected,
@@ -148,8 +148,8 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 					LOG_INFO(
 						"Opening browser for account: " + account.displayName + " (ID: " + std::to_string(account.id) +
 						")");
-					Threading::newThread([acc = account]()
-										 { LaunchBrowserWithCookie(acc); });
+					Threading::interactive("webview.open", [acc = account]()
+										   { LaunchBrowserWithCookie(acc); });
 				}
 				else
 				{
@@ -199,14 +199,17 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 			};
 
 			render_centered_text_in_cell(account.username.c_str());
-			render_centered_text_in_cell(account.userId.c_str());
+			char user_id_text[24] = "";
+			if (account.userId)
+				snprintf(user_id_text, sizeof(user_id_text), "%llu", static_cast<unsigned long long>(account.userId));
+			render_centered_text_in_cell(user_id_text);
 
 			ImVec4 statusColor = getStatusColor(account.status);
 			TableNextColumn();
 			float status_y = GetCursorPosY();
 			SetCursorPosY(status_y + vertical_padding);
-			TextColored(statusColor, "%s", account.status.c_str());
-			if (account.status == "Banned" && account.banExpiry > 0 && IsItemHovered())
+			TextColored(statusColor, "%s", toString(account.status));
+			if (account.status == AccountStatus::Banned && account.banExpiry > 0 && IsItemHovered())
 			{
 				BeginTooltip();
 				string timeStr = formatCountdown(account.banExpiry);
@@ -219,14 +222,14 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 			float voice_y = GetCursorPosY();
 			SetCursorPosY(voice_y + vertical_padding);
 			ImVec4 voiceCol = ImVec4(1.f, 1.f, 1.f, 1.f);
-			if (account.voiceStatus == "Enabled")
+			if (account.voiceStatus == VoiceStatus::Enabled)
 				voiceCol = ImVec4(0.7f, 1.f, 0.7f, 1.f); // Pastel green
-			else if (account.voiceStatus == "Disabled")
+			else if (account.voiceStatus == VoiceStatus::Disabled)
 				voiceCol = ImVec4(1.f, 1.f, 0.7f, 1.f); // Pastel yellow
-			else if (account.voiceStatus == "Banned")
+			else if (account.voiceStatus == VoiceStatus::Banned)
 				voiceCol = ImVec4(1.f, 0.7f, 0.7f, 1.f); // Pastel red
 
-			if (account.voiceStatus == "Banned" && account.voiceBanExpiry > 0)
+			if (account.voiceStatus == VoiceStatus::Banned && account.voiceBanExpiry > 0)
 			{
 				time_t now = time(nullptr);
 				if (now >= account.voiceBanExpiry &&
@@ -236,24 +239,22 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 					s_voiceUpdateInProgress.insert(account.id);
 					int accId = account.id;
 					string cookie = account.cookie;
-					Threading::newThread([accId, cookie]()
-										 {
+					Threading::background("accounts.voice_refresh", [accId, cookie]()
+										   {
 						auto vs = Roblox::getVoiceChatStatus(cookie);
-						MainThread::Post([accId, vs]() {
-							auto it = find_if(g_accounts.begin(), g_accounts.end(),
-							                  [&](const AccountData &a) { return a.id == accId; });
-							if (it != g_accounts.end()) {
-								it->voiceStatus = vs.status;
-								it->voiceBanExpiry = vs.bannedUntil;
-							}
+						AccountStore::instance().update(accId, [&](AccountData &a) {
+							a.voiceStatus = vs.status;
+							a.voiceBanExpiry = vs.bannedUntil;
+						});
+						MainThread::Post([accId]() {
 							s_voiceUpdateInProgress.erase(accId);
 							Data::SaveAccounts();
 						}); });
 				}
 			}
 
-			TextColored(voiceCol, "%s", account.voiceStatus.c_str());
-			if (account.voiceStatus == "Banned" && account.voiceBanExpiry > 0 && IsItemHovered())
+			TextColored(voiceCol, "%s", toString(account.voiceStatus));
+			if (account.voiceStatus == VoiceStatus::Banned && account.voiceBanExpiry > 0 && IsItemHovered())
 			{
 				BeginTooltip();
 				string timeStr = formatCountdown(account.voiceBanExpiry);
@@ -288,13 +289,11 @@ void RenderAccountsTable(vector<AccountData> &accounts_to_display, const char *t
 		Spacing();
 		if (Button("Open", ImVec2(openWidth, 0)) && s_urlBuffer[0] != '\0')
 		{
-			auto it = find_if(g_accounts.begin(), g_accounts.end(), [&](const AccountData &a)
-							  { return a.id == s_urlPopupAccountId; });
-			if (it != g_accounts.end())
+			if (auto acc = AccountStore::instance().find(s_urlPopupAccountId))
 			{
 				string url = s_urlBuffer;
-				Threading::newThread([acc = *it, url]()
-									 { LaunchWebview(url, acc.username + " - " + acc.userId, acc.cookie); });
+				Threading::interactive("webview.open", [acc = *acc, url]()
+									   { LaunchWebview(url, acc.username + " - " + to_string(acc.userId), acc.cookie); });
 			}
 			s_urlBuffer[0] = '\0';
 			CloseCurrentPopup();
@@ -341,7 +340,9 @@ void RenderFullAccountsTabContent()
 	if (availH <= total_height_for_join_ui_and_sep)
 		tableH = GetFrameHeight() * 3.0f;
 
-	RenderAccountsTable(g_accounts, "AccountsTable", tableH);
+	// Held for the whole frame so rows stay valid while the table draws.
+	auto accounts = AccountStore::instance().snapshot();
+	RenderAccountsTable(*accounts, "AccountsTable", tableH);
 
 	Separator();
 	RenderJoinOptions();
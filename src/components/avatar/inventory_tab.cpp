@@ -5,7 +5,8 @@
 #include <string>
 #include "ui/image.h"
 #include "system/threading.h"
-#include "system/main_thread.h"
+#include "system/task_scope.h"
+#include "network/http_async.h"
 #include "../data.h"
 #include <nlohmann/json.hpp>
 #include <vector>
@@ -56,6 +57,65 @@ static std::vector<uint64_t> s_equippedAssetIds;
 static int s_activeThumbLoads = 0;
 constexpr int kMaxConcurrentThumbLoads = 24; // tweak as needed
 
+// Everything fetched for the user currently shown; reset when that changes so
+// requests for the previous user stop and their results are dropped.
+static Threading::TaskScope s_userScope;
+
+// Resolves the 75x75 thumbnail URL for an asset and downloads it on the async HTTP engine;
+// only the texture upload runs on the main thread.
+static void LoadAssetThumbnail(uint64_t assetId) {
+    Threading::WithToken scoped(s_userScope.token());
+    auto finish = [assetId](bool success) {
+        Threading::postScoped([assetId, success]() {
+            auto &ti = s_thumbCache[assetId];
+            ti.loading = false;
+            ti.failed = !success;
+            --s_activeThumbLoads;
+        });
+    };
+
+    std::string metaUrl = Routes::url(Routes::Service::Thumbnails, "/v1/assets?assetIds=") + std::to_string(assetId) +
+                          "&size=75x75&format=Png";
+    HttpClient::AsyncEngine::instance().get(metaUrl, {}, [assetId, finish](HttpClient::Response metaResp) {
+        if (metaResp.status_code != 200 || metaResp.text.empty()) {
+            finish(false);
+            return;
+        }
+
+        nlohmann::json metaJson = HttpClient::decode(metaResp);
+        std::string imageUrl;
+        try {
+            if (metaJson.contains("data") && !metaJson["data"].empty()) {
+                const auto &d = metaJson["data"][0];
+                if (d.contains("imageUrl"))
+                    imageUrl = d["imageUrl"].get<std::string>();
+            }
+        } catch (...) {
+            imageUrl.clear();
+        }
+
+        if (imageUrl.empty()) {
+            finish(false);
+            return;
+        }
+
+        HttpClient::AsyncEngine::instance().submit(HttpClient::makeDownload(imageUrl), [assetId, finish](HttpClient::Response imgResp) {
+            if (imgResp.status_code != 200 || imgResp.text.empty()) {
+                finish(false);
+                return;
+            }
+
+            Threading::postScoped([assetId, data = std::move(imgResp.text)]() mutable {
+                auto &ti = s_thumbCache[assetId];
+                bool ok = LoadTextureFromMemory(data.data(), data.size(), &ti.srv, &ti.width, &ti.height);
+                ti.loading = false;
+                ti.failed = !ok;
+                --s_activeThumbLoads;
+            });
+        });
+    });
+}
+
 void RenderInventoryTab() {
     // Persistent state across frames
     static ID3D11ShaderResourceView *s_texture = nullptr;
@@ -80,37 +140,32 @@ void RenderInventoryTab() {
     static char s_searchBuffer[64] = "";
 
     // Determine which user we should show
+    AccountSnapshot accountsSnapshot = AccountStore::instance().snapshot();
     uint64_t currentUserId = 0;
     std::string currentCookie;
     if (!g_selectedAccountIds.empty()) {
         int internalId = *g_selectedAccountIds.begin();
-        for (const auto &acc: g_accounts) {
-            if (acc.id == internalId && !acc.userId.empty()) {
-                try {
-                    currentUserId = std::stoull(acc.userId);
-                } catch (...) {
-                    currentUserId = 0;
-                }
+        for (const auto &acc: *accountsSnapshot) {
+            if (acc.id == internalId && acc.userId != 0) {
+                currentUserId = acc.userId;
                 currentCookie = acc.cookie;
                 break;
             }
         }
     } else if (g_defaultAccountId != -1) {
-        for (const auto &acc: g_accounts) {
-            if (acc.id == g_defaultAccountId && !acc.userId.empty()) {
-                try {
-                    currentUserId = std::stoull(acc.userId);
-                } catch (...) {
-                    currentUserId = 0;
-                }
+        for (const auto &acc: *accountsSnapshot) {
+            if (acc.id == g_defaultAccountId && acc.userId != 0) {
+                currentUserId = acc.userId;
                 currentCookie = acc.cookie;
                 break;
             }
         }
     }
 
-    // If account changed, reset state so we fetch a new avatar
+    // If account changed, stop whatever was still loading for the old one and
+    // reset state so we fetch a new avatar
     if (currentUserId != s_loadedUserId) {
+        s_userScope.reset();
         s_started = false;
         s_failed = false;
         s_loading = false;
@@ -139,6 +194,7 @@ void RenderInventoryTab() {
                 p.second.srv->Release();
         }
         s_thumbCache.clear();
+        s_activeThumbLoads = 0; // their completions were dropped with the scope
         // reset equipped list state
         s_equippedUserId = 0;
         s_equippedLoading = false;
@@ -157,18 +213,22 @@ void RenderInventoryTab() {
         s_started = true;
         s_loading = true;
 
-        Threading::newThread([currentUserId] {
-            // 420×420 PNG full-body avatar image
-            std::string metaUrl =
-                    "https://thumbnails.roblox.com/v1/users/avatar?userIds=" + std::to_string(currentUserId) +
-                    "&size=420x420&format=Png";
+        // 420×420 PNG full-body avatar image
+        std::string metaUrl =
+                Routes::url(Routes::Service::Thumbnails, "/v1/users/avatar?userIds=") + std::to_string(currentUserId) +
+                "&size=420x420&format=Png";
 
-            auto metaResp = HttpClient::get(metaUrl);
+        auto fail = [] {
+            Threading::postScoped([] {
+                s_loading = false;
+                s_failed = true;
+            });
+        };
+
+        Threading::WithToken scoped(s_userScope.token());
+        HttpClient::AsyncEngine::instance().get(metaUrl, {}, [fail](HttpClient::Response metaResp) {
             if (metaResp.status_code != 200 || metaResp.text.empty()) {
-                MainThread::Post([] {
-                    s_loading = false;
-                    s_failed = true;
-                });
+                fail();
                 return;
             }
 
@@ -184,31 +244,24 @@ void RenderInventoryTab() {
             }
 
             if (avatarUrl.empty()) {
-                MainThread::Post([] {
-                    s_loading = false;
-                    s_failed = true;
-                });
+                fail();
                 return;
             }
 
-            auto imgResp = HttpClient::get(avatarUrl);
-            if (imgResp.status_code != 200 || imgResp.text.empty()) {
-                MainThread::Post([] {
+            HttpClient::AsyncEngine::instance().submit(HttpClient::makeDownload(avatarUrl), [fail](HttpClient::Response imgResp) {
+                if (imgResp.status_code != 200 || imgResp.text.empty()) {
+                    fail();
+                    return;
+                }
+
+                Threading::postScoped([data = std::move(imgResp.text)]() mutable {
+                    if (LoadTextureFromMemory(data.data(), data.size(), &s_texture, &s_imageWidth, &s_imageHeight)) {
+                        s_failed = false;
+                    } else {
+                        s_failed = true;
+                    }
                     s_loading = false;
-                    s_failed = true;
                 });
-                return;
-            }
-
-            std::string data = std::move(imgResp.text);
-
-            MainThread::Post([data = std::move(data)]() mutable {
-                if (LoadTextureFromMemory(data.data(), data.size(), &s_texture, &s_imageWidth, &s_imageHeight)) {
-                    s_failed = false;
-                } else {
-                    s_failed = true;
-                }
-                s_loading = false;
             });
         });
     }
@@ -216,11 +269,11 @@ void RenderInventoryTab() {
     // Kick off categories fetch once
     if (!s_catLoading && s_categories.empty() && !s_catFailed) {
         s_catLoading = true;
-        Threading::newThread([currentUserId, cookie = currentCookie] {
-            std::string url = "https://inventory.roblox.com/v1/users/" + std::to_string(currentUserId) + "/categories";
+        s_userScope.interactive("inventory.categories", [currentUserId, cookie = currentCookie] {
+            std::string url = Routes::url(Routes::Service::Inventory, "/v1/users/") + std::to_string(currentUserId) + "/categories";
             auto resp = HttpClient::get(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
             if (resp.status_code != 200 || resp.text.empty()) {
-                MainThread::Post([] {
+                Threading::postScoped([] {
                     s_catLoading = false;
                     s_catFailed = true;
                 });
@@ -230,7 +283,7 @@ void RenderInventoryTab() {
             try {
                 j = HttpClient::decode(resp);
             } catch (...) {
-                MainThread::Post([] {
+                Threading::postScoped([] {
                     s_catLoading = false;
                     s_catFailed = true;
                 });
@@ -256,7 +309,7 @@ void RenderInventoryTab() {
                 }
             } catch (...) {
             }
-            MainThread::Post([categories = std::move(categories)]() mutable {
+            Threading::postScoped([categories = std::move(categories)]() mutable {
                 s_categories = std::move(categories);
                 s_catLoading = false;
                 s_catFailed = s_categories.empty();
@@ -286,11 +339,11 @@ void RenderInventoryTab() {
     if (currentUserId != 0 && currentUserId != s_equippedUserId && !s_equippedLoading) {
         s_equippedLoading = true;
         s_equippedFailed = false;
-        Threading::newThread([uid = currentUserId]() {
-            std::string url = "https://avatar.roblox.com/v1/users/" + std::to_string(uid) + "/currently-wearing";
+        s_userScope.background("inventory.wearing", [uid = currentUserId]() {
+            std::string url = Routes::url(Routes::Service::Avatar, "/v1/users/") + std::to_string(uid) + "/currently-wearing";
             auto resp = HttpClient::get(url);
             if (resp.status_code != 200 || resp.text.empty()) {
-                MainThread::Post([uid]() {
+                Threading::postScoped([uid]() {
                     s_equippedUserId = uid;
                     s_equippedFailed = true;
                     s_equippedLoading = false;
@@ -301,7 +354,7 @@ void RenderInventoryTab() {
             try {
                 j = HttpClient::decode(resp);
             } catch (...) {
-                MainThread::Post([uid]() {
+                Threading::postScoped([uid]() {
                     s_equippedUserId = uid;
                     s_equippedFailed = true;
                     s_equippedLoading = false;
@@ -321,7 +374,7 @@ void RenderInventoryTab() {
             } catch (...) {
             }
 
-            MainThread::Post([uid, ids = std::move(ids)]() mutable {
+            Threading::postScoped([uid, ids = std::move(ids)]() mutable {
                 // Discard if user changed while the request was in-flight
                 if (uid != s_catUserId)
                     return;
@@ -358,49 +411,7 @@ void RenderInventoryTab() {
             if (!thumb.srv && !thumb.loading && !thumb.failed && s_activeThumbLoads < kMaxConcurrentThumbLoads) {
                 thumb.loading = true;
                 ++s_activeThumbLoads;
-                Threading::newThread([assetId = aid]() {
-                    // identical download logic as before
-                    auto finish = [assetId](bool success) {
-                        MainThread::Post([assetId, success]() {
-                            auto &ti = s_thumbCache[assetId];
-                            ti.loading = false;
-                            ti.failed = !success;
-                            --s_activeThumbLoads;
-                        });
-                    };
-                    std::string metaUrl = "https://thumbnails.roblox.com/v1/assets?assetIds=" + std::to_string(assetId)
-                                          + "&size=75x75&format=Png";
-                    auto metaResp = HttpClient::get(metaUrl);
-                    if (metaResp.status_code != 200 || metaResp.text.empty()) {
-                        finish(false);
-                        return;
-                    }
-                    nlohmann::json metaJson = HttpClient::decode(metaResp);
-                    std::string imageUrl;
-                    try {
-                        if (metaJson.contains("data") && !metaJson["data"].empty()) {
-                            const auto &d = metaJson["data"][0];
-                            if (d.contains("imageUrl")) imageUrl = d["imageUrl"].get<std::string>();
-                        }
-                    } catch (...) { imageUrl.clear(); }
-                    if (imageUrl.empty()) {
-                        finish(false);
-                        return;
-                    }
-                    auto imgResp = HttpClient::get(imageUrl);
-                    if (imgResp.status_code != 200 || imgResp.text.empty()) {
-                        finish(false);
-                        return;
-                    }
-                    std::string data = std::move(imgResp.text);
-                    MainThread::Post([assetId, data = std::move(data)]() mutable {
-                        auto &ti = s_thumbCache[assetId];
-                        bool ok = LoadTextureFromMemory(data.data(), data.size(), &ti.srv, &ti.width, &ti.height);
-                        ti.loading = false;
-                        ti.failed = !ok;
-                        --s_activeThumbLoads;
-                    });
-                });
+                LoadAssetThumbnail(aid);
             }
 
             // Ensure unique ImGui IDs for each equipped item to avoid conflicts.
@@ -523,13 +534,13 @@ void RenderInventoryTab() {
     if (itInv == s_cachedInventories.end() && !s_invLoading) {
         s_invLoading = true;
         s_invFailed = false;
-        Threading::newThread([currentUserId, cookie = currentCookie, assetTypeId] {
+        s_userScope.interactive("inventory.items", [currentUserId, cookie = currentCookie, assetTypeId] {
             std::vector<InventoryItem> items;
 
             std::string cursor; // pagination cursor, empty for first page
             bool anyError = false;
             while (!anyError) {
-                std::string url = "https://inventory.roblox.com/v2/users/" + std::to_string(currentUserId) +
+                std::string url = Routes::url(Routes::Service::Inventory, "/v2/users/") + std::to_string(currentUserId) +
                                   "/inventory/" + std::to_string(assetTypeId) + "?limit=100&sortOrder=Asc";
                 if (!cursor.empty())
                     url += "&cursor=" + cursor;
@@ -572,7 +583,7 @@ void RenderInventoryTab() {
                     break; // no more pages
             }
 
-            MainThread::Post([assetTypeId, anyError, items = std::move(items)]() mutable {
+            Threading::postScoped([assetTypeId, anyError, items = std::move(items)]() mutable {
                 if (!anyError) {
                     s_cachedInventories[assetTypeId] = std::move(items);
                     s_invFailed = false;
@@ -654,58 +665,7 @@ void RenderInventoryTab() {
                         kMaxConcurrentThumbLoads) {
                         thumb.loading = true;
                         ++s_activeThumbLoads;
-                        Threading::newThread([assetId = itm.assetId]() {
-                            auto finishWithState = [assetId](bool success) {
-                                MainThread::Post([assetId, success]() {
-                                    auto &ti = s_thumbCache[assetId];
-                                    ti.loading = false;
-                                    ti.failed = !success;
-                                    --s_activeThumbLoads;
-                                });
-                            };
-
-                            std::string metaUrl = "https://thumbnails.roblox.com/v1/assets?assetIds=" + std::to_string(
-                                                      assetId) +
-                                                  "&size=75x75&format=Png";
-                            auto metaResp = HttpClient::get(metaUrl);
-                            if (metaResp.status_code != 200 || metaResp.text.empty()) {
-                                finishWithState(false);
-                                return;
-                            }
-
-                            nlohmann::json metaJson = HttpClient::decode(metaResp);
-                            std::string imageUrl;
-                            try {
-                                if (metaJson.contains("data") && !metaJson["data"].empty()) {
-                                    const auto &d = metaJson["data"][0];
-                                    if (d.contains("imageUrl"))
-                                        imageUrl = d["imageUrl"].get<std::string>();
-                                }
-                            } catch (...) {
-                                imageUrl.clear();
-                            }
-
-                            if (imageUrl.empty()) {
-                                finishWithState(false);
-                                return;
-                            }
-
-                            auto imgResp = HttpClient::get(imageUrl);
-                            if (imgResp.status_code != 200 || imgResp.text.empty()) {
-                                finishWithState(false);
-                                return;
-                            }
-
-                            std::string data = std::move(imgResp.text);
-                            MainThread::Post([assetId, data = std::move(data)]() mutable {
-                                auto &ti = s_thumbCache[assetId];
-                                bool ok = LoadTextureFromMemory(data.data(), data.size(), &ti.srv, &ti.width,
-                                                                &ti.height);
-                                ti.loading = false;
-                                ti.failed = !ok;
-                                --s_activeThumbLoads;
-                            });
-                        });
+                        LoadAssetThumbnail(itm.assetId);
                     }
 
                     PushID(itemIndex);
@@ -1,5 +1,6 @@
 #include "backup.h"
 #include "data.h"
+#include "accounts/account_scheduler.h"
 #include "../utils/core/logging.hpp"
 #include "../utils/system/threading.h"
 #include "network/roblox.h"
@@ -76,7 +77,8 @@ bool Backup::Export(const std::string &password) {
     }
     // accounts
     json accounts = json::array();
-    for (const auto &acct : g_accounts) {
+    auto snapshot = AccountStore::instance().snapshot();
+    for (const auto &acct : *snapshot) {
         accounts.push_back({
             {"id", acct.id},
             {"cookie", acct.cookie},
@@ -123,23 +125,28 @@ bool Backup::Import(const std::string &file, const std::string &password, std::s
         return false;
     }
 
-    g_accounts.clear();
+    // One authentication per cookie, all in flight together, instead of
+    // separate id/name/display-name lookups for every account.
+    std::vector<std::string> cookies;
+    for (auto &item : j["accounts"])
+        cookies.push_back(item.value("cookie", ""));
+    auto profiles = Roblox::authenticateProfiles(cookies);
+
+    AccountList imported;
+    size_t index = 0;
     for (auto &item : j["accounts"]) {
         AccountData acct;
         acct.id = item.value("id", 0);
         acct.cookie = item.value("cookie", "");
         acct.note = item.value("note", "");
         acct.isFavorite = item.value("isFavorite", false);
-        uint64_t uid = Roblox::getUserId(acct.cookie);
-        acct.userId = std::to_string(uid);
-        acct.username = Roblox::getUsername(acct.cookie);
-        acct.displayName = Roblox::getDisplayName(acct.cookie);
-        acct.status = Roblox::getPresence(acct.cookie, uid);
-        auto vs = Roblox::getVoiceChatStatus(acct.cookie);
-        acct.voiceStatus = vs.status;
-        acct.voiceBanExpiry = vs.bannedUntil;
-        g_accounts.push_back(std::move(acct));
+        const auto &profile = profiles[index++];
+        acct.userId = profile.userId;
+        acct.username = profile.username;
+        acct.displayName = profile.displayName;
+        imported.push_back(std::move(acct));
     }
+    AccountStore::instance().modify([&](AccountList &accounts) { accounts = std::move(imported); });
     if (j.contains("settings")) {
         std::ofstream s(Data::StorageFilePath("settings.json"));
         s << j["settings"].dump(4);
@@ -152,5 +159,8 @@ bool Backup::Import(const std::string &file, const std::string &password, std::s
     Data::LoadAccounts();
     Data::LoadSettings();
     Data::LoadFavorites();
+    // Moderation, presence and voice for the new list come from the regular
+    // refresh pipeline, in the background.
+    AccountRefresh::Scheduler::instance().refreshAllNow();
     return true;
 }
@@ -4,7 +4,7 @@
 #include "data.h"
 #include "servers/servers.h"
 
-void RenderAccountsTable(std::vector<AccountData> &, const char *, float);
+void RenderAccountsTable(const std::vector<AccountData> &, const char *, float);
 
 bool RenderMainMenu();
 
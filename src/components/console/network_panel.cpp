@@ -0,0 +1,129 @@
+#include "network_panel.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../data.h"
+#include "../accounts/account_refresh.h"
+#include "core/logging.hpp"
+#include "network/http_metrics.h"
+#include "system/main_thread.h"
+#include "system/task.h"
+#include "system/task_scope.h"
+#include "system/timers.h"
+
+using namespace ImGui;
+using namespace std;
+
+static string formatBytes(uint64_t bytes) {
+	char buf[32];
+	if (bytes >= 1024ull * 1024)
+		snprintf(buf, sizeof(buf), "%.1f MiB", bytes / (1024.0 * 1024.0));
+	else if (bytes >= 1024)
+		snprintf(buf, sizeof(buf), "%.1f KiB", bytes / 1024.0);
+	else
+		snprintf(buf, sizeof(buf), "%llu B", static_cast<unsigned long long>(bytes));
+	return buf;
+}
+
+// "200:12 429:3" for the status column; failures have no status code.
+static string formatStatuses(const HttpClient::EndpointSnapshot &e) {
+	string out;
+	for (const auto &[code, n]: e.statusCounts) {
+		if (!out.empty())
+			out += ' ';
+		out += to_string(code) + ":" + to_string(n);
+	}
+	if (e.failures > 0)
+		out += (out.empty() ? "" : " ") + string("err:") + to_string(e.failures);
+	return out;
+}
+
+namespace NetworkPanel {
+	void Render() {
+		auto rows = HttpClient::Metrics::instance().snapshot();
+		// Slowest first: that's what you open this panel to find.
+		sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) { return a.p95 > b.p95; });
+
+		if (Button("Export JSON")) {
+			string path = Data::StorageFilePath("network_metrics.json");
+			ofstream out{path};
+			if (out.is_open()) {
+				out << HttpClient::Metrics::instance().snapshotJson().dump(4);
+				LOG_INFO("Exported network metrics to " + path);
+			} else {
+				LOG_ERROR("Could not open " + path + " for writing");
+			}
+		}
+		SameLine();
+		if (Button("Copy JSON"))
+			SetClipboardText(HttpClient::Metrics::instance().snapshotJson().dump(2).c_str());
+		SameLine();
+		if (Button("Reset"))
+			HttpClient::Metrics::instance().reset();
+
+		if (auto cycle = AccountRefresh::LastReport())
+			TextWrapped("%s", AccountRefresh::Describe(*cycle).c_str());
+
+		auto ui = MainThread::GetStats();
+		TextWrapped("UI queue: %zu queued (max %zu), %llu run; %llu frames hit the %.1f ms budget, %llu deferred work, "
+		            "longest drain %.1f ms",
+		            ui.depth, ui.maxDepth, static_cast<unsigned long long>(ui.run),
+		            static_cast<unsigned long long>(ui.overruns), MainThread::budgetMicros.load() / 1000.0,
+		            static_cast<unsigned long long>(ui.deferredFrames), ui.maxDrainMs);
+		TextWrapped("Timers: %s", Timers::describe().c_str());
+		TextWrapped("Task scopes: %s", Threading::describeScopes().c_str());
+		TextWrapped("Coroutines: %s", Async::describe().c_str());
+
+		ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+		                        ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Resizable;
+		if (!BeginTable("NetworkMetrics", 12, flags, GetContentRegionAvail()))
+			return;
+		TableSetupScrollFreeze(1, 1);
+		TableSetupColumn("Endpoint", ImGuiTableColumnFlags_WidthStretch);
+		TableSetupColumn("Reqs");
+		TableSetupColumn("Active");
+		TableSetupColumn("p50 ms");
+		TableSetupColumn("p95 ms");
+		TableSetupColumn("p99 ms");
+		TableSetupColumn("In");
+		TableSetupColumn("Out");
+		TableSetupColumn("Retries");
+		TableSetupColumn("Cached");
+		TableSetupColumn("Cancelled");
+		TableSetupColumn("Statuses");
+		TableHeadersRow();
+
+		for (const auto &e: rows) {
+			TableNextRow();
+			TableNextColumn();
+			TextUnformatted(e.name.c_str());
+			TableNextColumn();
+			Text("%llu", static_cast<unsigned long long>(e.requests));
+			TableNextColumn();
+			Text("%llu", static_cast<unsigned long long>(e.inFlight));
+			TableNextColumn();
+			Text("%.0f", e.p50);
+			TableNextColumn();
+			Text("%.0f", e.p95);
+			TableNextColumn();
+			Text("%.0f", e.p99);
+			TableNextColumn();
+			TextUnformatted(formatBytes(e.bytesIn).c_str());
+			TableNextColumn();
+			TextUnformatted(formatBytes(e.bytesOut).c_str());
+			TableNextColumn();
+			Text("%llu", static_cast<unsigned long long>(e.retries));
+			TableNextColumn();
+			Text("%llu", static_cast<unsigned long long>(e.cacheHits));
+			TableNextColumn();
+			Text("%llu", static_cast<unsigned long long>(e.cancelled));
+			TableNextColumn();
+			TextUnformatted(formatStatuses(e).c_str());
+		}
+		EndTable();
+	}
+}
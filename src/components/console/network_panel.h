@@ -0,0 +1,6 @@
+#pragma once
+
+namespace NetworkPanel {
+    // Per-endpoint HTTP latency/throughput table with JSON export.
+    void Render();
+}
@@ -13,13 +13,15 @@
 #include "core/base64.h"
 #include "core/logging.hpp"
 #include "core/app_state.h"
+#include "system/main_thread.h"
+#include "network/routes.h"
+#include "network/roblox/ban_cache.h"
 
 #pragma comment(lib, "Crypt32.lib")
 
 using namespace std;
 using json = nlohmann::json;
 
-vector<AccountData> g_accounts;
 set<int> g_selectedAccountIds;
 
 vector<FavoriteGame> g_favorites;
@@ -31,10 +33,86 @@ int g_defaultAccountId = -1;
 array<char, 128> s_jobIdBuffer = {};
 array<char, 128> s_playerBuffer = {};
 int g_statusRefreshInterval = 1;
+int g_httpTransportMode = 0;
+bool g_prewarmConnections = true;
 bool g_checkUpdatesOnStartup = true;
 bool g_killRobloxOnLaunch = false;
 bool g_clearCacheOnLaunch = false;
 
+AccountStore &AccountStore::instance() {
+    static AccountStore store;
+    return store;
+}
+
+AccountStore::AccountStore() : current_(std::make_shared<const AccountList>()) {
+}
+
+AccountSnapshot AccountStore::snapshot() const {
+    return current_.load(std::memory_order_acquire);
+}
+
+uint64_t AccountStore::version() const {
+    return version_.load(std::memory_order_acquire);
+}
+
+void AccountStore::modify(const Mutation &mutation) {
+    std::lock_guard<std::mutex> lock(writeMtx_);
+    AccountList next = *current_.load(std::memory_order_acquire);
+    mutation(next);
+    publishLocked(std::move(next));
+}
+
+bool AccountStore::update(int accountId, const std::function<void(AccountData &)> &change) {
+    bool found = false;
+    modify([&](AccountList &accounts) {
+        for (auto &acct: accounts) {
+            if (acct.id == accountId) {
+                change(acct);
+                found = true;
+                return;
+            }
+        }
+    });
+    return found;
+}
+
+void AccountStore::enqueue(Mutation mutation) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx_);
+        pending_.push_back(std::move(mutation));
+    }
+    MainThread::Wake(); // the render loop commits
+}
+
+size_t AccountStore::commit() {
+    std::vector<Mutation> batch; {
+        std::lock_guard<std::mutex> lock(pendingMtx_);
+        batch.swap(pending_);
+    }
+    if (batch.empty())
+        return 0;
+    std::lock_guard<std::mutex> lock(writeMtx_);
+    AccountList next = *current_.load(std::memory_order_acquire);
+    for (auto &mutation: batch)
+        mutation(next);
+    publishLocked(std::move(next));
+    return batch.size();
+}
+
+std::optional<AccountData> AccountStore::find(int accountId) const {
+    auto accounts = snapshot();
+    for (const auto &acct: *accounts) {
+        if (acct.id == accountId)
+            return acct;
+    }
+    return std::nullopt;
+}
+
+void AccountStore::publishLocked(AccountList next) {
+    current_.store(std::make_shared<const AccountList>(std::move(next)), std::memory_order_release);
+    version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 vector<BYTE> encryptData(const string &plainText) {
     DATA_BLOB DataIn;
     DATA_BLOB DataOut;
@@ -121,15 +199,16 @@ namespace Data {
             return;
         }
 
-        g_accounts.clear();
+        AccountList loaded;
         for (auto &item: dataArray) {
             AccountData account;
             account.id = item.value("id", 0);
             account.displayName = item.value("displayName", "");
             account.username = item.value("username", "");
-            account.userId = item.value("userId", "");
-            account.status = item.value("status", "");
-            account.voiceStatus = item.value("voiceStatus", "");
+            // Stored as a string; parsed once here rather than on every refresh.
+            account.userId = strtoull(item.value("userId", "").c_str(), nullptr, 10);
+            account.status = accountStatusFromString(item.value("status", ""));
+            account.voiceStatus = voiceStatusFromString(item.value("voiceStatus", ""));
             account.voiceBanExpiry = item.value("voiceBanExpiry", 0);
             account.banExpiry = item.value("banExpiry", 0);
             account.note = item.value("note", "");
@@ -162,12 +241,17 @@ namespace Data {
                     " has an unencrypted cookie. It will be encrypted on next save.");
             }
 
-            g_accounts.push_back(move(account));
+            loaded.push_back(move(account));
         }
-        LOG_INFO("Loaded " + std::to_string(g_accounts.size()) + " accounts");
+        LOG_INFO("Loaded " + std::to_string(loaded.size()) + " accounts");
+        AccountStore::instance().modify([&](AccountList &accounts) { accounts = move(loaded); });
     }
 
     void SaveAccounts(const string &filename) {
+        // Called from the UI and from refresh threads alike.
+        static std::mutex saveMutex;
+        std::lock_guard<std::mutex> saveLock(saveMutex);
+        AccountSnapshot accounts = AccountStore::instance().snapshot();
         string path = MakePath(filename);
         ofstream out{path};
         if (!out.is_open()) {
@@ -176,7 +260,7 @@ namespace Data {
         }
 
         json dataArray = json::array();
-        for (auto &account: g_accounts) {
+        for (auto &account: *accounts) {
             string b64EncryptedCookie;
             if (!account.cookie.empty()) {
                 try {
@@ -194,9 +278,9 @@ namespace Data {
                 {"id", account.id},
                 {"displayName", account.displayName},
                 {"username", account.username},
-                {"userId", account.userId},
-                {"status", account.status},
-                {"voiceStatus", account.voiceStatus},
+                {"userId", account.userId ? to_string(account.userId) : string()},
+                {"status", toString(account.status)},
+                {"voiceStatus", toString(account.voiceStatus)},
                 {"voiceBanExpiry", account.voiceBanExpiry},
                 {"banExpiry", account.banExpiry},
                 {"note", account.note},
@@ -205,7 +289,7 @@ namespace Data {
             });
         }
         out << dataArray.dump(4);
-        LOG_INFO("Saved " + std::to_string(g_accounts.size()) + " accounts");
+        LOG_INFO("Saved " + std::to_string(accounts->size()) + " accounts");
     }
 
     void LoadFavorites(const std::string &filename) {
@@ -271,11 +355,21 @@ namespace Data {
             g_killRobloxOnLaunch = j.value("killRobloxOnLaunch", false);
             g_clearCacheOnLaunch = j.value("clearCacheOnLaunch", false);
             g_multiRobloxEnabled = j.value("multiRobloxEnabled", false);
+            g_httpTransportMode = j.value("httpTransportMode", 0);
+            g_prewarmConnections = j.value("prewarmConnections", true);
+            Routes::Router::instance().configure(j.value("routes", nlohmann::json::object()));
+            Roblox::BanStatusCache::instance().setTtl(std::chrono::seconds(j.value("banCacheTtlSeconds", 300)),
+                                                      std::chrono::seconds(j.value("banCacheNegativeTtlSeconds", 60)));
             LOG_INFO("Default account ID = " + std::to_string(g_defaultAccountId));
             LOG_INFO("Status refresh interval = " + std::to_string(g_statusRefreshInterval));
             LOG_INFO("Check updates on startup = " + std::string(g_checkUpdatesOnStartup ? "true" : "false"));
             LOG_INFO("Kill Roblox on launch = " + std::string(g_killRobloxOnLaunch ? "true" : "false"));
             LOG_INFO("Clear cache on launch = " + std::string(g_clearCacheOnLaunch ? "true" : "false"));
+            LOG_INFO("HTTP transport mode = " + std::to_string(g_httpTransportMode));
+            LOG_INFO("Prewarm connections = " + std::string(g_prewarmConnections ? "true" : "false"));
+            LOG_INFO("HTTP routes = " + Routes::Router::instance().toJson().dump());
+            LOG_INFO("Ban cache TTL = " + std::to_string(Roblox::BanStatusCache::instance().positiveTtl().count()) +
+                     "s clean, " + std::to_string(Roblox::BanStatusCache::instance().negativeTtl().count()) + "s negative");
         } catch (const std::exception &e) {
             LOG_ERROR("Failed to parse " + filename + ": " + e.what());
         }
@@ -289,6 +383,11 @@ namespace Data {
         j["killRobloxOnLaunch"] = g_killRobloxOnLaunch;
         j["clearCacheOnLaunch"] = g_clearCacheOnLaunch;
         j["multiRobloxEnabled"] = g_multiRobloxEnabled;
+        j["httpTransportMode"] = g_httpTransportMode;
+        j["prewarmConnections"] = g_prewarmConnections;
+        j["routes"] = Routes::Router::instance().toJson();
+        j["banCacheTtlSeconds"] = Roblox::BanStatusCache::instance().positiveTtl().count();
+        j["banCacheNegativeTtlSeconds"] = Roblox::BanStatusCache::instance().negativeTtl().count();
         std::string path = MakePath(filename);
         std::ofstream out{path};
         if (!out.is_open()) {
@@ -302,6 +401,8 @@ namespace Data {
         LOG_INFO("Saved killRobloxOnLaunch=" + std::string(g_killRobloxOnLaunch ? "true" : "false"));
         LOG_INFO("Saved clearCacheOnLaunch=" + std::string(g_clearCacheOnLaunch ? "true" : "false"));
         LOG_INFO("Saved multiRobloxEnabled=" + std::string(g_multiRobloxEnabled ? "true" : "false"));
+        LOG_INFO("Saved httpTransportMode=" + std::to_string(g_httpTransportMode));
+        LOG_INFO("Saved prewarmConnections=" + std::string(g_prewarmConnections ? "true" : "false"));
     }
 
     void LoadFriends(const std::string &filename) {
@@ -5,23 +5,34 @@
 #include <string>
 #include <set>
 #include <array>
+#include <atomic>
 #include <ctime>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <imgui.h>
 #include "history/log_types.h"
+#include "network/roblox/common.h"
 
+// One flat record. The fixed-size fields that table rows, launch filters
+// and scheduler passes read are ordered first so they share 32 bytes;
+// names, note and cookie follow in the same record, so a snapshot copy
+// still copies every string.
 struct AccountData {
 	int id = 0;
+	AccountStatus status = AccountStatus::Unknown;
+	VoiceStatus voiceStatus = VoiceStatus::Unknown;
+	bool isFavorite = false;
+	uint64_t userId = 0;
+	time_t banExpiry = 0;
+	time_t voiceBanExpiry = 0;
 	std::string displayName;
 	std::string username;
-	std::string userId;
-	std::string status;
-	std::string voiceStatus;
-	time_t voiceBanExpiry = 0;
-	time_t banExpiry = 0;
 	std::string note;
 	std::string cookie;
-	bool isFavorite = false;
 };
 
 struct FavoriteGame {
@@ -41,8 +52,53 @@ struct FriendInfo {
 	std::string gameId;
 };
 
+using AccountList = std::vector<AccountData>;
+using AccountSnapshot = std::shared_ptr<const AccountList>;
+
+// Owns the managed accounts. Readers take an immutable, versioned snapshot
+// (one atomic load, no lock) and can hold it as long as they like; writers
+// never touch a published list but apply mutations to a copy and publish
+// that as the next version. Background work enqueues its mutations and the
+// main loop commits them together once per frame, so a refresh touching
+// hundreds of rows costs one copy per frame rather than one per row.
+class AccountStore {
+public:
+	using Mutation = std::function<void(AccountList &)>;
+
+	static AccountStore &instance();
+
+	AccountSnapshot snapshot() const;
+
+	uint64_t version() const;
+
+	// Applies a mutation and publishes the result immediately.
+	void modify(const Mutation &mutation);
+
+	// Changes one account, if it still exists. Returns whether it did.
+	bool update(int accountId, const std::function<void(AccountData &)> &change);
+
+	// Queues a mutation for the next commit().
+	void enqueue(Mutation mutation);
+
+	// Applies every queued mutation to a single copy and publishes it.
+	// Returns how many were applied.
+	size_t commit();
+
+	std::optional<AccountData> find(int accountId) const;
+
+private:
+	AccountStore();
+
+	void publishLocked(AccountList next);
+
+	std::atomic<AccountSnapshot> current_;
+	std::atomic<uint64_t> version_{0};
+	std::mutex writeMtx_;
+	std::mutex pendingMtx_;
+	std::vector<Mutation> pending_;
+};
+
 extern std::vector<FavoriteGame> g_favorites;
-extern std::vector<AccountData> g_accounts;
 extern std::vector<FriendInfo> g_friends;
 extern std::unordered_map<int, std::vector<FriendInfo> > g_accountFriends;
 extern std::unordered_map<int, std::vector<FriendInfo> > g_unfriendedFriends;
@@ -54,6 +110,8 @@ extern int g_statusRefreshInterval;
 extern bool g_checkUpdatesOnStartup;
 extern bool g_killRobloxOnLaunch;
 extern bool g_clearCacheOnLaunch;
+extern int g_httpTransportMode;
+extern bool g_prewarmConnections;
 extern std::array<char, 128> s_jobIdBuffer;
 extern std::array<char, 128> s_playerBuffer;
 
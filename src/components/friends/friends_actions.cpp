@@ -1,6 +1,7 @@
 #include "friends_actions.h"
 #include "network/roblox.h"
 #include "core/status.h"
+#include "system/threading.h"
 #include <algorithm>
 #include <vector>
 #include <string>
@@ -29,6 +30,11 @@ namespace FriendsActions {
         LOG_INFO("Fetching friends list...");
 
         auto list = Roblox::getFriends(userId, cookie);
+        // Cancelled calls come back empty. Stop before that empty list gets
+        // compared with the saved one and everyone is marked as unfriended;
+        // the loading flag now belongs to whichever account replaced this one.
+        if (Threading::cancelled())
+            return;
 
         vector<uint64_t> ids;
         ids.reserve(list.size());
@@ -50,6 +56,8 @@ namespace FriendsActions {
                 continue;
 
             auto presMap = Roblox::getPresences(batch_ids, cookie);
+            if (Threading::cancelled())
+                return;
 
             for (const auto &[uid, pdata]: presMap) {
                 auto it = find_if(list.begin(), list.end(),
@@ -137,7 +145,10 @@ namespace FriendsActions {
         atomic<bool> &loadingFlag) {
         loadingFlag = true;
         LOG_INFO("Fetching friend details...");
-        outFriendDetail = Roblox::getUserDetails(friendId, cookie);
+        auto detail = Roblox::getUserDetails(friendId, cookie);
+        if (Threading::cancelled())
+            return;
+        outFriendDetail = std::move(detail);
         loadingFlag = false;
         LOG_INFO("Friend details loaded.");
     }
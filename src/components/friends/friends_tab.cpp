@@ -11,6 +11,7 @@
 #include "network/roblox.h"
 #include "system/launcher.hpp"
 #include "system/threading.h"
+#include "system/task_scope.h"
 #include "./friends_actions.h"
 #include "ui/webview.hpp"
 #include "../games/games_utils.h"
@@ -32,6 +33,10 @@ static int g_lastAcctIdForFriends = -1;
 // selected account but can be changed via the UI combo box.
 static int g_viewAcctId = -1;
 
+// Loads for the account being viewed; reset when g_viewAcctId changes so the
+// previous account's list and details stop loading and never land.
+static Threading::TaskScope s_viewScope;
+
 static auto ICON_TOOL = "\xEF\x82\xAD ";
 static auto ICON_PERSON = "\xEF\x80\x87 ";
 static auto ICON_CONTROLLER = "\xEF\x84\x9B ";
@@ -67,6 +72,9 @@ static const char *presenceIcon(const string &p)
 
 void RenderFriendsTab()
 {
+    AccountSnapshot accountsSnapshot = AccountStore::instance().snapshot();
+    const AccountList &allAccounts = *accountsSnapshot;
+
     if (g_selectedAccountIds.empty())
     {
         TextDisabled("Select an account in the Accounts tab to view its friends.");
@@ -76,18 +84,18 @@ void RenderFriendsTab()
     // Ensure the currently viewed account is valid and not banned.
     auto isCurrentViewAccount = [&](const AccountData &a)
     {
-        return a.id == g_viewAcctId && a.status != "Banned" && a.status != "Terminated";
+        return a.id == g_viewAcctId && !isRestricted(a.status);
     };
 
-    if (g_viewAcctId == -1 || std::none_of(g_accounts.begin(), g_accounts.end(), isCurrentViewAccount))
+    if (g_viewAcctId == -1 || std::none_of(allAccounts.begin(), allAccounts.end(), isCurrentViewAccount))
     {
         // Prefer a selected, non-banned account if one exists
         g_viewAcctId = -1;
         for (int id : g_selectedAccountIds)
         {
-            auto itSel = std::find_if(g_accounts.begin(), g_accounts.end(), [&](const AccountData &a)
-                                      { return a.id == id && a.status != "Banned" && a.status != "Terminated"; });
-            if (itSel != g_accounts.end())
+            auto itSel = std::find_if(allAccounts.begin(), allAccounts.end(), [&](const AccountData &a)
+                                      { return a.id == id && !isRestricted(a.status); });
+            if (itSel != allAccounts.end())
             {
                 g_viewAcctId = id;
                 break;
@@ -96,20 +104,20 @@ void RenderFriendsTab()
         // Fallback to the first non-banned account in the list
         if (g_viewAcctId == -1)
         {
-            auto itFirst = std::find_if(g_accounts.begin(), g_accounts.end(), [&](const AccountData &a)
-                                        { return a.status != "Banned" && a.status != "Terminated"; });
-            if (itFirst != g_accounts.end())
+            auto itFirst = std::find_if(allAccounts.begin(), allAccounts.end(), [&](const AccountData &a)
+                                        { return !isRestricted(a.status); });
+            if (itFirst != allAccounts.end())
                 g_viewAcctId = itFirst->id;
         }
     }
 
     int currentAcctId = g_viewAcctId;
-    auto it = find_if(g_accounts.begin(), g_accounts.end(),
+    auto it = find_if(allAccounts.begin(), allAccounts.end(),
                       [&](auto &a)
                       {
                           return a.id == currentAcctId;
                       });
-    if (it == g_accounts.end())
+    if (it == allAccounts.end())
     {
         TextDisabled("Selected account not found.");
         return;
@@ -119,6 +127,7 @@ void RenderFriendsTab()
 
     if (currentAcctId != g_lastAcctIdForFriends)
     {
+        s_viewScope.reset();
         g_friends.clear();
         g_selectedFriendIdx = -1;
         g_selectedFriend = {};
@@ -127,18 +136,19 @@ void RenderFriendsTab()
         g_unfriended = g_unfriendedFriends[currentAcctId];
         g_lastAcctIdForFriends = currentAcctId;
 
-        if (!acct.userId.empty())
+        if (acct.userId != 0)
         {
-            Threading::newThread(FriendsActions::RefreshFullFriendsList, acct.id, acct.userId, acct.cookie,
-                                 ref(g_friends),
-                                 ref(g_friendsLoading));
+            s_viewScope.interactive("friends.refresh", FriendsActions::RefreshFullFriendsList, acct.id,
+                                    to_string(acct.userId), acct.cookie,
+                                    ref(g_friends),
+                                    ref(g_friendsLoading));
         }
     }
     {
         float maxLabelWidth = 0.0f;
-        for (const auto &acc : g_accounts)
+        for (const auto &acc : allAccounts)
         {
-            if (acc.status == "Banned" || acc.status == "Terminated")
+            if (isRestricted(acc.status))
                 continue; // Skip banned and terminated accounts in the dropdown
             const string &labelStr = acc.displayName.empty() ? acc.username : acc.displayName;
             float w = CalcTextSize(labelStr.c_str()).x;
@@ -155,9 +165,9 @@ void RenderFriendsTab()
         const char *currentLabel = acct.displayName.empty() ? acct.username.c_str() : acct.displayName.c_str();
         if (BeginCombo("##AccountSelector", currentLabel))
         {
-            for (const auto &acc : g_accounts)
+            for (const auto &acc : allAccounts)
             {
-                if (acc.status == "Banned" || acc.status == "Terminated")
+                if (isRestricted(acc.status))
                     continue; // Skip banned and terminated accounts in the dropdown
                 const char *label = acc.displayName.empty() ? acc.username.c_str() : acc.displayName.c_str();
                 bool isSelected = (acc.id == g_viewAcctId);
@@ -176,12 +186,13 @@ void RenderFriendsTab()
     SameLine();
 
     BeginDisabled(g_friendsLoading.load());
-    if (Button((string(ICON_REFRESH) + " Refresh").c_str()) && !acct.userId.empty())
+    if (Button((string(ICON_REFRESH) + " Refresh").c_str()) && acct.userId != 0)
     {
         g_selectedFriendIdx = -1;
         g_selectedFriend = {};
-        Threading::newThread(FriendsActions::RefreshFullFriendsList, acct.id, acct.userId, acct.cookie, ref(g_friends),
-                             ref(g_friendsLoading));
+        s_viewScope.interactive("friends.refresh", FriendsActions::RefreshFullFriendsList, acct.id,
+                                to_string(acct.userId), acct.cookie, ref(g_friends),
+                                ref(g_friendsLoading));
     }
     SameLine();
     if (Button((string(ICON_USER_PLUS) + " Add Friend").c_str()))
@@ -215,8 +226,8 @@ void RenderFriendsTab()
         {
             string input = trim_copy(s_addFriendBuffer);
             s_addFriendLoading = true;
-            Threading::newThread([input, cookie = acct.cookie]()
-                                 {
+            Threading::interactive("friends.add", [input, cookie = acct.cookie]()
+                                   {
                 try {
                     uint64_t uid = 0;
                     if (input.empty()) throw runtime_error("Username not provided");
@@ -305,15 +316,14 @@ void RenderFriendsTab()
                         vector<pair<int, string>> accounts;
                         for (int id : g_selectedAccountIds)
                         {
-                            auto itA = find_if(g_accounts.begin(), g_accounts.end(), [&](const AccountData &a)
-                                               { return a.id == id && a.status != "Banned" && a.status != "Terminated"; });
-                            if (itA != g_accounts.end())
+                            auto itA = find_if(allAccounts.begin(), allAccounts.end(), [&](const AccountData &a)
+                                               { return a.id == id && !isRestricted(a.status); });
+                            if (itA != allAccounts.end())
                                 accounts.emplace_back(itA->id, itA->cookie);
                         }
                         if (!accounts.empty())
                         {
-                            Threading::newThread([row = f, accounts]()
-                                                 { launchRobloxSequential(row.placeId, row.gameId, accounts); });
+                            launchRobloxSequential(f.placeId, f.gameId, accounts);
                         }
                     }
                     if (MenuItem("Fill Join Options"))
@@ -364,8 +374,8 @@ void RenderFriendsTab()
                     string cookieCopy = acct.cookie;
                     int acctIdCopy = acct.id;
                     ConfirmPopup::Add(buf, [fCopy, friendId, cookieCopy, acctIdCopy]()
-                                      { Threading::newThread([fCopy, friendId, cookieCopy, acctIdCopy]()
-                                                             {
+                                      { Threading::interactive("friends.unfriend", [fCopy, friendId, cookieCopy, acctIdCopy]()
+                                                               {
                             string resp;
                             bool ok = Roblox::unfriend(to_string(friendId), cookieCopy, &resp);
                             if (ok) {
@@ -420,11 +430,11 @@ void RenderFriendsTab()
                 if (g_selectedFriend.id != f.id)
                 {
                     g_selectedFriend = {};
-                    Threading::newThread(FriendsActions::FetchFriendDetails,
-                                         to_string(f.id),
-                                         acct.cookie,
-                                         ref(g_selectedFriend),
-                                         ref(g_friendDetailsLoading));
+                    s_viewScope.interactive("friends.details", FriendsActions::FetchFriendDetails,
+                                            to_string(f.id),
+                                            acct.cookie,
+                                            ref(g_selectedFriend),
+                                            ref(g_friendDetailsLoading));
                 }
             }
             PopID();
@@ -625,16 +635,15 @@ void RenderFriendsTab()
                 vector<pair<int, string>> accounts;
                 for (int id : g_selectedAccountIds)
                 {
-                    auto it = find_if(g_accounts.begin(), g_accounts.end(),
+                    auto it = find_if(allAccounts.begin(), allAccounts.end(),
                                       [&](const AccountData &a)
-                                      { return a.id == id && a.status != "Banned" && a.status != "Terminated"; });
-                    if (it != g_accounts.end())
+                                      { return a.id == id && !isRestricted(a.status); });
+                    if (it != allAccounts.end())
                         accounts.emplace_back(it->id, it->cookie);
                 }
                 if (!accounts.empty())
                 {
-                    Threading::newThread([row, accounts]()
-                                         { launchRobloxSequential(row.placeId, row.gameId, accounts); });
+                    launchRobloxSequential(row.placeId, row.gameId, accounts);
                 }
             }
             EndDisabled();
@@ -435,16 +435,12 @@ static void RenderGameDetailsPanel(float panelWidth, float availableHeight) {
             if (!g_selectedAccountIds.empty()) {
                 vector<pair<int, string> > accounts;
                 for (int id: g_selectedAccountIds) {
-                    auto it = find_if(g_accounts.begin(), g_accounts.end(),
-                                      [&](const AccountData &a) { return a.id == id; });
-                    if (it != g_accounts.end() && it->status != "Banned" && it->status != "Terminated")
-                        accounts.emplace_back(it->id, it->cookie);
+                    auto acct = AccountStore::instance().find(id);
+                    if (acct && !isRestricted(acct->status))
+                        accounts.emplace_back(acct->id, acct->cookie);
                 }
                 if (!accounts.empty()) {
-                    thread([placeId = gameInfo.placeId, accounts]() {
-                                launchRobloxSequential(placeId, "", accounts);
-                            })
-                            .detach();
+                    launchRobloxSequential(gameInfo.placeId, "", accounts);
                 } else {
                     Status::Error("Selected account not found to launch game.");
                 }
@@ -465,8 +461,10 @@ static void RenderGameDetailsPanel(float panelWidth, float availableHeight) {
             OpenPopup("GamePageMenu");
         OpenPopupOnItemClick("GamePageMenu");
         if (BeginPopup("GamePageMenu")) {
-            if (MenuItem("Roblox Page"))
-                LaunchWebview("https://www.roblox.com/games/" + to_string(gameInfo.placeId), "Game Page", g_accounts.empty() ? "" : g_accounts.front().cookie);
+            if (MenuItem("Roblox Page")) {
+                AccountSnapshot accounts = AccountStore::instance().snapshot();
+                LaunchWebview("https://www.roblox.com/games/" + to_string(gameInfo.placeId), "Game Page", accounts->empty() ? "" : accounts->front().cookie);
+            }
             if (MenuItem("Rolimons"))
                 LaunchWebview("https://www.rolimons.com/game/" + to_string(gameInfo.placeId) + "/", "Rolimons");
             if (MenuItem("RoMonitor"))
@@ -19,6 +19,7 @@
 #include "history_utils.h"
 
 #include "system/threading.h"
+#include "system/timers.h"
 #include "system/launcher.hpp"
 #include "ui/modal_popup.h"
 #include "core/status.h"
@@ -65,7 +66,7 @@ static void refreshLogs() {
 		return;
 
 	g_logs_loading = true;
-	Threading::newThread([]() {
+	Threading::background("history.scan_logs", []() {
 		LOG_INFO("Scanning Roblox logs folder...");
 		vector<LogInfo> tempLogs;
 		string dir = logsFolder();
@@ -109,7 +110,10 @@ static void refreshLogs() {
 	});
 }
 
+// Picks up logs written since the last look without re-parsing known ones.
 static void workerScan() {
+	if (g_logs_loading.load())
+		return;
 	string dir = logsFolder();
 	if (dir.empty() || !fs::exists(dir))
 		return;
@@ -143,6 +147,9 @@ static void workerScan() {
 
 	if (!tempLogs.empty()) {
 		lock_guard<mutex> lk(g_logs_mtx);
+		string selected;
+		if (g_selected_log_idx >= 0 && g_selected_log_idx < static_cast<int>(g_logs.size()))
+			selected = g_logs[g_selected_log_idx].fileName;
 		for (auto &log: tempLogs) {
 			auto it = find_if(g_logs.begin(), g_logs.end(),
 			                  [&](const LogInfo &a) { return a.fileName == log.fileName; });
@@ -152,10 +159,12 @@ static void workerScan() {
 		sort(g_logs.begin(), g_logs.end(), [](const LogInfo &a, const LogInfo &b) {
 			return b.timestamp < a.timestamp;
 		});
+		// Keep the same log selected now that rows have moved.
+		auto it = find_if(g_logs.begin(), g_logs.end(), [&](const LogInfo &a) { return a.fileName == selected; });
+		g_selected_log_idx = selected.empty() || it == g_logs.end() ? -1 : static_cast<int>(it - g_logs.begin());
 		Data::SaveLogHistory(g_logs);
+		LOG_INFO("Log watcher: " + to_string(tempLogs.size()) + " new log(s)");
 	}
-
-	refreshLogs();
 }
 
 static void startLogWatcher() { {
@@ -163,6 +172,7 @@ static void startLogWatcher() { {
 		g_logs = Data::LoadLogHistory();
 	}
 	refreshLogs();
+	Timers::every("history.watch_logs", chrono::seconds(10), workerScan);
 }
 
 static void DisplayOptionalText(const char *label, const string &value) {
@@ -350,17 +360,13 @@ void RenderHistoryTab() {
 					if (place_id_val > 0) {
 						vector<pair<int, string> > accounts;
                                                 for (int id: g_selectedAccountIds) {
-                                                        auto it = find_if(g_accounts.begin(), g_accounts.end(),
-                                                                          [&](const AccountData &a) { return a.id == id; });
-                                                        if (it != g_accounts.end() && it->status != "Banned" && it->status != "Terminated")
-                                                                accounts.emplace_back(it->id, it->cookie);
+                                                        auto acct = AccountStore::instance().find(id);
+                                                        if (acct && !isRestricted(acct->status))
+                                                                accounts.emplace_back(acct->id, acct->cookie);
                                                 }
 						if (!accounts.empty()) {
 							LOG_INFO("Launching game from history...");
-							thread([place_id_val, jobId = logInfo.jobId, accounts]() {
-										launchRobloxSequential(place_id_val, jobId, accounts);
-									})
-									.detach();
+							launchRobloxSequential(place_id_val, logInfo.jobId, accounts);
 						} else {
 							LOG_INFO("Selected account not found.");
 						}
@@ -9,6 +9,10 @@
 #include <filesystem>
 
 #include "network/roblox.h"
+#include "accounts/account_bench.h"
+#include "accounts/account_scheduler.h"
+#include "network/http_bench.h"
+#include "system/frame_pacer.h"
 #include "system/threading.h"
 #include "system/roblox_control.h"
 #include "system/multi_instance.h"
@@ -51,29 +55,8 @@ bool RenderMainMenu() {
 
                 if (BeginMenu("Accounts")) {
                         if (MenuItem("Refresh Statuses")) {
-                                Threading::newThread([] {
-                                        LOG_INFO("Refreshing account statuses...");
-                                        for (auto &acct: g_accounts) {
-                                                auto banStatus = Roblox::refreshBanStatus(acct.cookie);
-                                                if (banStatus == Roblox::BanCheckResult::Banned) {
-                                                        acct.status = "Banned";
-                                                        continue;
-                                                }
-                                                if (banStatus == Roblox::BanCheckResult::Terminated) {
-                                                        acct.status = "Terminated";
-                                                        continue;
-                                                }
-
-						if (!acct.userId.empty()) {
-							acct.status = Roblox::getPresence(acct.cookie, stoull(acct.userId));
-							auto vs = Roblox::getVoiceChatStatus(acct.cookie);
-							acct.voiceStatus = vs.status;
-							acct.voiceBanExpiry = vs.bannedUntil;
-						}
-					}
-					Data::SaveAccounts();
-					LOG_INFO("Refreshed account statuses");
-				});
+                                LOG_INFO("Refreshing account statuses...");
+                                AccountRefresh::Scheduler::instance().refreshAllNow();
 			}
 
 			Separator();
@@ -92,36 +75,40 @@ bool RenderMainMenu() {
 					if (canAdd && MenuItem("Add Cookie", nullptr, false, canAdd)) {
 						const string cookie = s_cookieInputBuffer.data();
 						try {
-							int maxId = 0;
-							for (auto &acct: g_accounts) {
-								if (acct.id > maxId)
-									maxId = acct.id;
-							}
-							int nextId = maxId + 1;
-
-							uint64_t uid = Roblox::getUserId(cookie);
-							string username = Roblox::getUsername(cookie);
-							string displayName = Roblox::getDisplayName(cookie);
-							string presence = Roblox::getPresence(cookie, uid);
+							auto profile = Roblox::authenticateProfiles({cookie}).front();
+							uint64_t uid = profile.userId;
+							string username = move(profile.username);
+							string displayName = move(profile.displayName);
+							AccountStatus presence = accountStatusFromString(Roblox::getPresence(cookie, uid));
 							auto vs = Roblox::getVoiceChatStatus(cookie);
 
 							AccountData newAcct;
-							newAcct.id = nextId;
 							newAcct.cookie = cookie;
-							newAcct.userId = to_string(uid);
+							newAcct.userId = uid;
 							newAcct.username = move(username);
 							newAcct.displayName = move(displayName);
-							newAcct.status = move(presence);
+							newAcct.status = presence;
 							newAcct.voiceStatus = vs.status;
 							newAcct.voiceBanExpiry = vs.bannedUntil;
 							newAcct.note = "";
 							newAcct.isFavorite = false;
 
-							g_accounts.push_back(move(newAcct));
+							// Pick the id inside the mutation so a concurrent add can't take it too.
+							int nextId = 0;
+							AccountStore::instance().modify([&](AccountList &accounts) {
+								int maxId = 0;
+								for (auto &acct: accounts) {
+									if (acct.id > maxId)
+										maxId = acct.id;
+								}
+								nextId = maxId + 1;
+								newAcct.id = nextId;
+								accounts.push_back(newAcct);
+							});
 
 							LOG_INFO("Added account " +
 								to_string(nextId) + " - " +
-								g_accounts.back().displayName.c_str());
+								newAcct.displayName.c_str());
 
 							Data::SaveAccounts();
 						} catch (const exception &ex) {
@@ -141,11 +128,13 @@ bool RenderMainMenu() {
 				PushStyleColor(ImGuiCol_Text, ImVec4(1.f, 0.4f, 0.4f, 1.f));
 				if (MenuItem(buf)) {
 					ConfirmPopup::Add("Delete selected accounts?", []() {
-						erase_if(
-							g_accounts,
-							[&](const AccountData &acct) {
-								return g_selectedAccountIds.count(acct.id);
-							});
+						AccountStore::instance().modify([](AccountList &accounts) {
+							erase_if(
+								accounts,
+								[&](const AccountData &acct) {
+									return g_selectedAccountIds.count(acct.id);
+								});
+						});
 						g_selectedAccountIds.clear();
 						Data::SaveAccounts();
 						LOG_INFO("Deleted selected accounts.");
@@ -190,7 +179,28 @@ bool RenderMainMenu() {
 				if (RobloxControl::IsRobloxRunning())
 					s_openClearCachePopup = true;
 				else
-					Threading::newThread(RobloxControl::ClearRobloxCache);
+					Threading::interactive("roblox.clear_cache", RobloxControl::ClearRobloxCache);
+			}
+
+			if (BeginMenu("Diagnostics")) {
+				if (MenuItem("Benchmark HTTP Engine")) {
+					Threading::background("bench.http", [] { HttpBench::RunAsyncVsThreads(); });
+				}
+				if (MenuItem("Benchmark Account List")) {
+					Threading::background("bench.accounts", [] { AccountBench::RunAccountList(); });
+				}
+				if (MenuItem("Benchmark Account Refresh")) {
+					Threading::background("bench.refresh", [] { AccountBench::RunRefreshCycle(); });
+				}
+				if (MenuItem("Measure Idle CPU")) {
+					Threading::background("bench.idle_cpu", [] { FramePacer::MeasureIdleCpu(); });
+				}
+				if (MenuItem("Replay HTTP Capture")) {
+					Threading::background("bench.capture_replay", [] {
+						HttpBench::RunCaptureReplay(Data::StorageFilePath(HttpClient::kCaptureFileName));
+					});
+				}
+				ImGui::EndMenu();
 			}
 
                         ImGui::EndMenu();
@@ -212,12 +222,12 @@ bool RenderMainMenu() {
 		float cancelW = CalcTextSize("Cancel").x + GetStyle().FramePadding.x * 2.0f;
 		if (Button("Kill", ImVec2(killW, 0))) {
 			RobloxControl::KillRobloxProcesses();
-			Threading::newThread(RobloxControl::ClearRobloxCache);
+			Threading::interactive("roblox.clear_cache", RobloxControl::ClearRobloxCache);
 			CloseCurrentPopup();
 		}
 		SameLine(0, GetStyle().ItemSpacing.x);
 		if (Button("Don't kill", ImVec2(dontW, 0))) {
-			Threading::newThread(RobloxControl::ClearRobloxCache);
+			Threading::interactive("roblox.clear_cache", RobloxControl::ClearRobloxCache);
 			CloseCurrentPopup();
 		}
 		SameLine(0, GetStyle().ItemSpacing.x);
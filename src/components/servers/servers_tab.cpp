@@ -267,17 +267,13 @@ void RenderServersTab() {
                 if (!g_selectedAccountIds.empty()) {
                     vector<pair<int, string> > accounts;
                     for (int id: g_selectedAccountIds) {
-                        auto it = find_if(g_accounts.begin(), g_accounts.end(),
-                                          [&](const AccountData &a) { return a.id == id; });
-                        if (it != g_accounts.end() && it->status != "Banned" && it->status != "Terminated")
-                            accounts.emplace_back(it->id, it->cookie);
+                        auto acct = AccountStore::instance().find(id);
+                        if (acct && !isRestricted(acct->status))
+                            accounts.emplace_back(acct->id, acct->cookie);
                     }
                     if (!accounts.empty()) {
                         LOG_INFO("Joining server (left-click)...");
-                        thread([accounts, pId = g_current_placeId_servers, jId = srv.jobId]() {
-                                    launchRobloxSequential(pId, jId, accounts);
-                                })
-                                .detach();
+                        launchRobloxSequential(g_current_placeId_servers, srv.jobId, accounts);
                     } else {
                         LOG_INFO("Selected account not found.");
                     }
@@ -318,17 +314,13 @@ void RenderServersTab() {
                     if (!g_selectedAccountIds.empty()) {
                         vector<pair<int, string> > accounts;
                         for (int id: g_selectedAccountIds) {
-                            auto it = find_if(g_accounts.begin(), g_accounts.end(),
-                                              [&](const AccountData &a) { return a.id == id; });
-                            if (it != g_accounts.end() && it->status != "Banned")
-                                accounts.emplace_back(it->id, it->cookie);
+                            auto acct = AccountStore::instance().find(id);
+                            if (acct && acct->status != AccountStatus::Banned)
+                                accounts.emplace_back(acct->id, acct->cookie);
                         }
                         if (!accounts.empty()) {
                             LOG_INFO("Joining server (context menu)...");
-                            thread([accounts, pId = g_current_placeId_servers, jId = srv.jobId]() {
-                                        launchRobloxSequential(pId, jId, accounts);
-                                    })
-                                    .detach();
+                            launchRobloxSequential(g_current_placeId_servers, srv.jobId, accounts);
                         } else {
                             LOG_INFO("Selected account not found.");
                         }
@@ -8,40 +8,51 @@
 #include "core/app_state.h"
 #include "../../utils/system/multi_instance.h"
 #include "../console/console.h"
+#include "../console/network_panel.h"
+#include "network/transport.h"
+#include "network/routes.h"
+#include <cstdio>
 
 using namespace ImGui;
 using namespace std;
 
 // Static flag to manage console modal visibility
 static bool g_requestOpenConsoleModal = false;
+static bool g_requestOpenNetworkModal = false;
 
 void RenderSettingsTab() {
         // Button to open the Console modal (always visible)
         if (Button("Open Console")) {
                 g_requestOpenConsoleModal = true;
         }
+        SameLine();
+        if (Button("Network Stats")) {
+                g_requestOpenNetworkModal = true;
+        }
         Spacing();
 
-        if (!g_accounts.empty()) {
+        AccountSnapshot accountsSnapshot = AccountStore::instance().snapshot();
+        const AccountList &allAccounts = *accountsSnapshot;
+        if (!allAccounts.empty()) {
                 SeparatorText("Accounts");
                 Text("Default Account:");
 
                 // Build a list of non-banned accounts for the dropdown
                 std::vector<const char *> names;
-                std::vector<size_t> idxMap; // maps combo index -> g_accounts index
-                names.reserve(g_accounts.size());
-                idxMap.reserve(g_accounts.size());
+                std::vector<size_t> idxMap; // maps combo index -> allAccounts index
+                names.reserve(allAccounts.size());
+                idxMap.reserve(allAccounts.size());
 
                 int current_default_idx = -1;
-                for (size_t i = 0; i < g_accounts.size(); ++i) {
-                        if (g_accounts[i].status == "Banned" || g_accounts[i].status == "Terminated")
+                for (size_t i = 0; i < allAccounts.size(); ++i) {
+                        if (isRestricted(allAccounts[i].status))
                                 continue; // Skip banned and terminated accounts
 
-                        const char *labelPtr = g_accounts[i].displayName.c_str();
+                        const char *labelPtr = allAccounts[i].displayName.c_str();
                         names.push_back(labelPtr);
                         idxMap.push_back(i);
 
-                        if (g_accounts[i].id == g_defaultAccountId) {
+                        if (allAccounts[i].id == g_defaultAccountId) {
                                 current_default_idx = static_cast<int>(names.size() - 1);
                         }
                 }
@@ -51,7 +62,7 @@ void RenderSettingsTab() {
                 if (!names.empty()) {
                         if (Combo("##defaultAccountCombo", &combo_idx, names.data(), static_cast<int>(names.size()))) {
                                 if (combo_idx >= 0 && combo_idx < static_cast<int>(idxMap.size())) {
-                                        g_defaultAccountId = g_accounts[idxMap[combo_idx]].id;
+                                        g_defaultAccountId = allAccounts[idxMap[combo_idx]].id;
 
                                         g_selectedAccountIds.clear();
                                         g_selectedAccountIds.insert(g_defaultAccountId);
@@ -111,6 +122,40 @@ void RenderSettingsTab() {
                 TextDisabled("No accounts available to set a default.");
         }
 
+        Spacing();
+        SeparatorText("Network");
+        // Record appends every exchange to the capture file; the replay modes
+        // answer from it without touching the network.
+        const char *transportModes[] = {"Live", "Record", "Replay", "Replay (no latency)"};
+        int transportMode = g_httpTransportMode;
+        if (Combo("HTTP Transport", &transportMode, transportModes, IM_ARRAYSIZE(transportModes))) {
+                g_httpTransportMode = transportMode;
+                HttpClient::Transport::instance().configure(static_cast<HttpClient::TransportMode>(transportMode),
+                                                            Data::StorageFilePath(HttpClient::kCaptureFileName));
+                Data::SaveSettings("settings.json");
+        }
+
+        bool prewarmConnections = g_prewarmConnections;
+        if (Checkbox("Prewarm API connections on startup", &prewarmConnections)) {
+                g_prewarmConnections = prewarmConnections;
+                Data::SaveSettings("settings.json");
+        }
+
+        // Points every API service at <mock>/<original host>, e.g. a capture
+        // served by the stub server. Per-service proxy pools live in settings.json.
+        static char mockBase[256] = "";
+        static bool mockBaseLoaded = false;
+        if (!mockBaseLoaded) {
+                snprintf(mockBase, sizeof(mockBase), "%s", Routes::Router::instance().mockBase().c_str());
+                mockBaseLoaded = true;
+        }
+        InputTextWithHint("Mock API Base", "http://127.0.0.1:8080 (empty = live hosts)", mockBase, IM_ARRAYSIZE(mockBase));
+        SameLine();
+        if (Button("Apply##mockBase")) {
+                Routes::Router::instance().setMockBase(mockBase);
+                Data::SaveSettings("settings.json");
+        }
+
         // Handle Console modal rendering
         if (g_requestOpenConsoleModal) {
                 OpenPopup("ConsolePopup");
@@ -147,4 +192,32 @@ void RenderSettingsTab() {
 
                 EndPopup();
         }
+
+        if (g_requestOpenNetworkModal) {
+                OpenPopup("NetworkPopup");
+                g_requestOpenNetworkModal = false;
+        }
+
+        SetNextWindowSize(desiredSize, ImGuiCond_Always);
+        if (BeginPopupModal("NetworkPopup", nullptr, ImGuiWindowFlags_NoResize)) {
+                ImGuiStyle &style = GetStyle();
+
+                float closeBtnWidth = CalcTextSize("Close").x + style.FramePadding.x * 2.0f;
+                float childHeight = GetContentRegionAvail().y - GetFrameHeight() - style.ItemSpacing.y;
+                if (childHeight < 0)
+                        childHeight = 0;
+
+                BeginChild("NetworkArea", ImVec2(0, childHeight), ImGuiChildFlags_Border);
+                NetworkPanel::Render();
+                EndChild();
+
+                Spacing();
+
+                SetCursorPosX(GetContentRegionMax().x - closeBtnWidth);
+                if (Button("Close", ImVec2(closeBtnWidth, 0))) {
+                        CloseCurrentPopup();
+                }
+
+                EndPopup();
+        }
 }
@@ -18,15 +18,23 @@
 #include <objbase.h>
 
 #include "components/data.h"
+#include "components/accounts/account_refresh.h"
+#include "components/accounts/account_scheduler.h"
 #include "network/roblox.h"
 #include "ui/notifications.h"
 #include "core/logging.hpp"
 #include "ui/confirm.h"
 #include "system/main_thread.h"
+#include "system/frame_pacer.h"
+#include "system/task.h"
+#include "system/timers.h"
 #include "system/update.h"
+#include "network/prewarm.h"
 #include <cstdio>
 #include <thread>
 #include <chrono>
+#include <future>
+#include <memory>
 #include <algorithm>
 
 #include <windows.h>
@@ -179,6 +187,7 @@ int WINAPI WinMain(
     int nCmdShow) {
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
+    const auto launchTime = std::chrono::steady_clock::now();
 
     // Set DPI awareness first
     SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
@@ -193,65 +202,32 @@ int WINAPI WinMain(
     }
 
     Data::LoadSettings("settings.json");
+    HttpClient::HttpCache::instance().open(Data::StorageFilePath("http_cache"));
+    HttpClient::Transport::instance().configure(static_cast<HttpClient::TransportMode>(g_httpTransportMode),
+                                                Data::StorageFilePath(HttpClient::kCaptureFileName));
+    // Resolve and connect to every API host while the rest of startup runs.
+    std::shared_future<HttpClient::PrewarmResult> prewarm;
+    if (g_prewarmConnections)
+        prewarm = std::async(std::launch::async, HttpClient::prewarmConnections).share();
     if (g_checkUpdatesOnStartup) {
         CheckForUpdates();
     }
     Data::LoadAccounts("accounts.json");
     Data::LoadFriends("friends.json");
 
-    auto refreshAccounts = [] {
-        std::vector<int> invalidIds;
-        std::string names;
-        for (auto &acct: g_accounts) {
-            if (acct.cookie.empty())
-                continue;
-            auto banInfo = Roblox::checkBanStatus(acct.cookie);
-            if (banInfo.status == Roblox::BanCheckResult::InvalidCookie) {
-                invalidIds.push_back(acct.id);
-                if (!names.empty())
-                    names += ", ";
-                names += acct.displayName.empty() ? acct.username : acct.displayName;
-            } else if (banInfo.status == Roblox::BanCheckResult::Banned) {
-                acct.status = "Banned";
-                acct.banExpiry = banInfo.endDate;
-                g_selectedAccountIds.erase(acct.id);
-            } else if (banInfo.status == Roblox::BanCheckResult::Terminated) {
-                acct.status = "Terminated";
-                acct.banExpiry = 0;  // Terminated accounts don't have an end date
-                g_selectedAccountIds.erase(acct.id);
-            }
-        }
-        for (auto &acct: g_accounts) {
-            if (acct.status == "Banned" || acct.status == "Terminated" || acct.userId.empty())
-                continue;
-
-            uint64_t uid = 0;
-            try {
-                uid = std::stoull(acct.userId);
-                acct.status = Roblox::getPresence(acct.cookie, uid);
-                auto vs = Roblox::getVoiceChatStatus(acct.cookie);
-                acct.voiceStatus = vs.status;
-                acct.voiceBanExpiry = vs.bannedUntil;
-                acct.banExpiry = 0;
-            } catch (const std::exception &e) {
-                char errorMsg[256];
-                snprintf(errorMsg, sizeof(errorMsg), "Error converting userId %s: %s", acct.userId.c_str(),
-                         e.what());
-                LOG_ERROR(errorMsg);
-                acct.status = "Error: Invalid UserID";
-            }
-        }
-        Data::SaveAccounts();
-        LOG_INFO("Loaded accounts and refreshed statuses");
+    auto refreshAccounts = [](const std::vector<int> &accountIds) {
+        auto report = AccountRefresh::RefreshAccounts(accountIds);
+        LOG_INFO("Refreshed " + std::to_string(accountIds.size()) + " account statuses");
 
-        if (!invalidIds.empty()) {
-            std::string namesCopy = names;
-            MainThread::Post([invalidIds, namesCopy]() {
+        if (!report.invalidIds.empty()) {
+            MainThread::Post([invalidIds = report.invalidIds, names = report.invalidNames]() {
                 char buf[512];
-                snprintf(buf, sizeof(buf), "Invalid cookies for: %s. Remove them?", namesCopy.c_str());
+                snprintf(buf, sizeof(buf), "Invalid cookies for: %s. Remove them?", names.c_str());
                 ConfirmPopup::Add(buf, [invalidIds]() {
-                    erase_if(g_accounts, [&](const AccountData &a) {
-                        return std::find(invalidIds.begin(), invalidIds.end(), a.id) != invalidIds.end();
+                    AccountStore::instance().modify([&](AccountList &accounts) {
+                        erase_if(accounts, [&](const AccountData &a) {
+                            return std::find(invalidIds.begin(), invalidIds.end(), a.id) != invalidIds.end();
+                        });
                     });
                     for (int id: invalidIds) {
                         g_selectedAccountIds.erase(id);
@@ -262,14 +238,42 @@ int WINAPI WinMain(
         }
     };
 
-    Threading::newThread([refreshAccounts] {
-        refreshAccounts();
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::minutes(g_statusRefreshInterval));
-            LOG_INFO("Refreshing account statuses...");
-            refreshAccounts();
-            LOG_INFO("Refreshed account statuses");
-        }
+    // Each account comes due on its own schedule; the scheduler keeps one
+    // timer armed for the soonest and calls back here when it fires.
+    auto firstRefresh = std::make_shared<bool>(true);
+    AccountRefresh::Scheduler::instance().start([refreshAccounts, prewarm, launchTime, firstRefresh](
+        const std::vector<int> &due) {
+            auto &scheduler = AccountRefresh::Scheduler::instance();
+            if (*firstRefresh && prewarm.valid())
+                prewarm.wait_for(std::chrono::seconds(3));
+            refreshAccounts(due);
+            if (*firstRefresh) {
+                *firstRefresh = false;
+                double firstStatusMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - launchTime).count();
+                char startupMsg[160];
+                snprintf(startupMsg, sizeof(startupMsg),
+                         "Startup: first status refresh done %.0f ms after launch (prewarm %s)",
+                         firstStatusMs, prewarm.valid() ? "on" : "off");
+                LOG_INFO(startupMsg);
+                return;
+            }
+            char schedMsg[128];
+            snprintf(schedMsg, sizeof(schedMsg), "Refresh scheduler: %zu accounts tracked, next due in %.0f s",
+                     scheduler.tracked(), scheduler.secondsUntilNext());
+            LOG_INFO(schedMsg);
+        });
+
+    Timers::every("diagnostics.stats", std::chrono::minutes(5), [] {
+        LOG_INFO("HTTP pool: " + HttpClient::describe(HttpClient::SessionPool::instance().stats()));
+        LOG_INFO("HTTP transfer: " + HttpClient::describeTransferSizes());
+        LOG_INFO("HTTP limiter: " + HttpClient::describe(HttpClient::RateLimiter::instance().stats()));
+        LOG_INFO("HTTP coalescing: " + std::to_string(HttpClient::inflightRequests().saved()) +
+                 " duplicate requests joined an in-flight call");
+        LOG_INFO("HTTP cache: " + HttpClient::describe(HttpClient::HttpCache::instance().stats()));
+        LOG_INFO("Thread pool: " + Threading::describePool());
+        LOG_INFO("Timers: " + Timers::describe());
+        LOG_INFO("Coroutines: " + Async::describe());
     });
 
     WNDCLASSEXW wc = {
@@ -330,10 +334,16 @@ int WINAPI WinMain(
 
     auto clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
+    FramePacer::Init(hwnd);
+
     bool done = false;
     while (!done) {
+        // Sleeps here while nothing is happening; see FramePacer.
+        FramePacer::WaitForWork(g_SwapChainOccluded || IsIconic(hwnd), io.WantTextInput);
+
         MSG msg;
         while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE)) {
+            FramePacer::NoteMessage(msg.message);
             TranslateMessage(&msg);
             ::DispatchMessage(&msg);
             if (msg.message == WM_QUIT)
@@ -342,12 +352,12 @@ int WINAPI WinMain(
         if (done)
             break;
 
+        // Background results queued since the last frame land as one new snapshot.
+        AccountStore::instance().commit();
         MainThread::Process();
 
-        if (g_SwapChainOccluded && g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED) {
-            Sleep(10);
+        if (g_SwapChainOccluded && g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
             continue;
-        }
         g_SwapChainOccluded = false;
 
         if (g_ResizeWidth != 0 && g_ResizeHeight != 0) {
@@ -382,6 +392,7 @@ int WINAPI WinMain(
 
         HRESULT hr_present = g_pSwapChain->Present(1, 0);
         g_SwapChainOccluded = (hr_present == DXGI_STATUS_OCCLUDED);
+        FramePacer::FrameRendered();
     }
 
     ImGui_ImplDX11_Shutdown();
@@ -467,6 +478,7 @@ void CleanupRenderTarget() {
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    FramePacer::NoteWindowMessage(msg);
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
         return true;
 
@@ -0,0 +1,76 @@
+// Standalone capture server: serves a recorded http_capture.jsonl over
+// loopback so load tests can run against realistic payloads on a headless
+// box, without the app or network access.
+//
+//   stub_server <capture.jsonl> [--port N] [--no-latency]
+//
+// Live URLs map to http://127.0.0.1:<port>/<host>/<path>, the same as the
+// in-app Replay HTTP Capture diagnostic. Runs until interrupted.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "capture_server.h"
+
+namespace {
+	std::atomic<bool> g_stop{false};
+
+	void onSignal(int) { g_stop = true; }
+
+	int usage(const char *argv0) {
+		std::fprintf(stderr, "usage: %s <capture.jsonl> [--port N] [--no-latency]\n", argv0);
+		return 2;
+	}
+}
+
+int main(int argc, char **argv) {
+	std::string capturePath;
+	uint16_t port = 0;
+	bool withLatency = true;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+			port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "--no-latency") == 0) {
+			withLatency = false;
+		} else if (argv[i][0] == '-' || !capturePath.empty()) {
+			return usage(argv[0]);
+		} else {
+			capturePath = argv[i];
+		}
+	}
+	if (capturePath.empty())
+		return usage(argv[0]);
+
+	auto capture = std::make_shared<HttpClient::Capture>();
+	if (!capture->load(capturePath) || capture->size() == 0) {
+		std::fprintf(stderr, "stub_server: nothing to serve in %s\n", capturePath.c_str());
+		return 1;
+	}
+
+	StubServer::Server server;
+	if (!server.start(StubServer::captureHandler(capture, withLatency), port)) {
+		std::fprintf(stderr, "stub_server: could not listen on 127.0.0.1:%u\n", static_cast<unsigned>(port));
+		return 1;
+	}
+
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+	std::printf("Serving %zu exchanges from %s on %s (%s)\n", capture->size(), capturePath.c_str(),
+	            server.baseUrl().c_str(), withLatency ? "recorded latency" : "no latency");
+	std::fflush(stdout);
+
+	while (!g_stop)
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	server.stop();
+	std::printf("Served %llu requests\n", static_cast<unsigned long long>(server.requestsServed()));
+	return 0;
+}
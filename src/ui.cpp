@@ -98,12 +98,13 @@ bool RenderUI()
         {
             string selectedNames;
             bool first = true;
+            AccountSnapshot accounts = AccountStore::instance().snapshot();
             for (int id : g_selectedAccountIds)
             {
-                auto it = find_if(g_accounts.begin(), g_accounts.end(),
+                auto it = find_if(accounts->begin(), accounts->end(),
                                   [&](const AccountData &a)
                                   { return a.id == id; });
-                if (it == g_accounts.end())
+                if (it == accounts->end())
                     continue;
                 if (!first)
                     selectedNames += ", ";
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// FNV-1a, 64-bit. Not cryptographic: used for cache file names and map keys
+// where we don't want to keep the original string around.
+inline uint64_t fnv1a64(const std::string &data) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned char c: data) {
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+inline std::string toHex(uint64_t value) {
+	static const char digits[] = "0123456789abcdef";
+	std::string out(16, '0');
+	for (int i = 15; i >= 0; --i) {
+		out[i] = digits[value & 0xf];
+		value >>= 4;
+	}
+	return out;
+}
@@ -1,51 +1,44 @@
 ﻿#pragma once
 #include <mutex>
 #include <string>
-#include <thread>
 #include <chrono>
 #include "modal_popup.h"
+#include "system/main_thread.h"
+#include "system/timers.h"
 
 using namespace std;
 
 namespace Status {
 	inline mutex _mtx;
 	inline string _originalText = "Idle";
-	inline string _displayText = "Idle";
 
 	inline chrono::steady_clock::time_point _lastSetTime{};
+	inline uint64_t _generation = 0;
+	inline Timers::Id _tickTimer = 0;
+
+	// Asks for a redraw each second while a countdown runs, so it keeps
+	// moving while the render loop is idle. Ticks from a superseded Set
+	// stop on their own.
+	inline void _tick(uint64_t generation) {
+		MainThread::Wake();
+		lock_guard<mutex> lock(_mtx);
+		if (generation != _generation || chrono::steady_clock::now() - _lastSetTime > chrono::seconds(6))
+			return;
+		_tickTimer = Timers::after("status.countdown", chrono::seconds(1), [generation] { _tick(generation); },
+		                           Threading::Priority::Interactive);
+	}
 
+	// Counts down 5..0 beside the message, then reverts to "Idle". The
+	// countdown is worked out when the status bar asks; a single timer
+	// keeps the bar repainting until it runs out.
 	inline void Set(const string &s) {
-		auto tp = chrono::steady_clock::now(); {
-			lock_guard<mutex> lock(_mtx);
-			_originalText = s;
-			_displayText = _originalText + " (5)";
-			_lastSetTime = tp;
-		}
-
-		thread([tp, s]() {
-			for (int i = 5; i >= 0; --i) {
-				{
-					lock_guard<mutex> lock(_mtx);
-					if (_lastSetTime != tp) {
-						return;
-					}
-				}
-
-				this_thread::sleep_for(chrono::seconds(1));
-				lock_guard<mutex> lock(_mtx);
-
-				if (_lastSetTime == tp) {
-					if (i > 0) {
-						_displayText = s + " (" + to_string(i - 1) + ")";
-					} else {
-						_displayText = "Idle";
-						_originalText = "Idle";
-					}
-				} else {
-					return;
-				}
-			}
-		}).detach();
+		lock_guard<mutex> lock(_mtx);
+		_originalText = s;
+		_lastSetTime = chrono::steady_clock::now();
+		Timers::cancel(_tickTimer);
+		uint64_t generation = ++_generation;
+		_tickTimer = Timers::after("status.countdown", chrono::seconds(1), [generation] { _tick(generation); },
+		                           Threading::Priority::Interactive);
 	}
 
 	inline void Error(const string &s) {
@@ -55,6 +48,14 @@ namespace Status {
 
 	inline string Get() {
 		lock_guard<mutex> lock(_mtx);
-		return _displayText;
+		if (_lastSetTime == chrono::steady_clock::time_point{})
+			return _originalText;
+		auto elapsed = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - _lastSetTime).count();
+		if (elapsed > 5) {
+			_originalText = "Idle";
+			_lastSetTime = {};
+			return _originalText;
+		}
+		return _originalText + " (" + to_string(5 - elapsed) + ")";
 	}
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cctype>
+#include <memory>
+#include <string>
+
+#include "http_capture.h"
+#include "stub_server.h"
+
+// Serves a recorded capture over loopback so load tests exercise the real
+// HTTP stack (connections, parsing, the async engine) with realistic
+// payloads. The live host becomes the first path segment:
+//   https://games.roblox.com/v1/games?universeIds=1
+//   -> http://127.0.0.1:<port>/games.roblox.com/v1/games?universeIds=1
+namespace StubServer {
+	inline std::string stubUrlFor(const Server &server, const std::string &liveUrl) {
+		auto scheme = liveUrl.find("://");
+		return server.baseUrl() + "/" + (scheme == std::string::npos ? liveUrl : liveUrl.substr(scheme + 3));
+	}
+
+	inline Handler captureHandler(std::shared_ptr<HttpClient::Capture> capture, bool withLatency) {
+		return [capture = std::move(capture), withLatency](const Request &req) {
+			Response resp;
+			if (req.target.empty() || req.target[0] != '/') {
+				resp.status = 400;
+				resp.contentType = "text/plain";
+				resp.body = "bad request target";
+				return resp;
+			}
+			auto e = capture->next(req.method, "https://" + req.target.substr(1), req.body);
+			if (!e) {
+				resp.status = 404;
+				resp.contentType = "text/plain";
+				resp.body = "not in capture";
+				return resp;
+			}
+			resp.status = e->status;
+			resp.body = std::move(e->body);
+			if (withLatency)
+				resp.delayMs = static_cast<int>(e->latencyMs);
+			for (const auto &[name, value]: e->headers) {
+				std::string lower = name;
+				for (auto &c: lower)
+					c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+				// The stub writes its own framing and never compresses.
+				if (lower == "content-type")
+					resp.contentType = value;
+				else if (lower != "content-length" && lower != "content-encoding" && lower != "transfer-encoding" &&
+				         lower != "connection")
+					resp.headers[name] = value;
+			}
+			return resp;
+		};
+	}
+}
@@ -1,21 +1,52 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <initializer_list>
 #include <sstream>
+#include <thread>
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 #include "core/logging.hpp"
+#include "http_types.h"
+#include "http_pool.h"
+#include "rate_limiter.h"
+#include "single_flight.h"
+#include "http_cache.h"
+#include "transport.h"
+#include "http_metrics.h"
+#include "routes.h"
+#include "system/threading.h"
 
 using namespace std;
 
 namespace HttpClient {
-	struct Response {
-		int status_code;
-		string text;
-		map<string, string> headers;
-	};
+	// How many times a request is re-sent after 429 before the caller sees it.
+	inline constexpr int kMaxThrottleRetries = 3;
+
+	inline std::atomic<uint64_t> g_compressedBytes{0};
+	inline std::atomic<uint64_t> g_uncompressedBytes{0};
+
+	// Fills in the byte counters once a transfer has completed.
+	inline void noteBodySize(Response &resp, size_t wireBytes) {
+		resp.uncompressed_bytes = resp.text.size();
+		resp.compressed_bytes = wireBytes ? wireBytes : resp.text.size();
+		resp.content_encoding = headerValue(resp, "Content-Encoding");
+		g_compressedBytes += resp.compressed_bytes;
+		g_uncompressedBytes += resp.uncompressed_bytes;
+	}
+
+	inline string describeTransferSizes() {
+		uint64_t wire = g_compressedBytes, decoded = g_uncompressedBytes;
+		uint64_t saved = decoded > wire ? (decoded - wire) * 100 / decoded : 0;
+		return to_string(wire / 1024) + " KiB on the wire, " + to_string(decoded / 1024) + " KiB decoded (" +
+		       to_string(saved) + "% saved by compression)";
+	}
 
 	inline string build_kv_string(
 		initializer_list<pair<const string, string> > items,
@@ -31,18 +62,215 @@ namespace HttpClient {
 		return ss.str();
 	}
 
+	inline string withParameters(const string &url, const cpr::Parameters &params) {
+		thread_local cpr::CurlHolder holder;
+		string query = params.GetContent(holder);
+		if (query.empty())
+			return url;
+		return url + (url.find('?') == string::npos ? '?' : '&') + query;
+	}
+
+	inline Request makeGet(
+		const string &url,
+		initializer_list<pair<const string, string> > headers = {},
+		const cpr::Parameters &params = {}
+	) {
+		return {"GET", withParameters(url, params), cpr::Header{headers}, {}, true, 0, {}};
+	}
+
+	// Binary downloads (images, CDN assets) are already compressed; asking for
+	// gzip on top only costs server and client CPU.
+	inline Request makeDownload(const string &url) {
+		Request req = makeGet(url);
+		req.compress = false;
+		return req;
+	}
+
+	inline Request makePost(
+		const string &url,
+		initializer_list<pair<const string, string> > headers = {},
+		const string &jsonBody = string(),
+		initializer_list<pair<const string, string> > form = {}
+	) {
+		Request req{"POST", url, cpr::Header{headers}, {}, true, 0, {}};
+		if (!jsonBody.empty()) {
+			req.headers["Content-Type"] = "application/json";
+			req.body = jsonBody;
+		} else if (form.size() > 0) {
+			req.headers["Content-Type"] = "application/x-www-form-urlencoded";
+			req.body = build_kv_string(form);
+		}
+		return req;
+	}
+
+	inline Response toResponse(const cpr::Response &r) {
+		Response resp;
+		resp.status_code = static_cast<int>(r.status_code);
+		resp.text = r.text;
+		resp.headers = map<string, string>(r.header.begin(), r.header.end());
+		noteBodySize(resp, static_cast<size_t>(r.downloaded_bytes));
+		return resp;
+	}
+
+	// Single blocking send on a pooled session owned by the calling thread.
+	inline Response performOnce(const Request &req) {
+		auto session = SessionPool::instance().acquire(req.method, req.url);
+		session->SetUrl(cpr::Url{req.url});
+		session->SetHeader(req.headers);
+		session->SetParameters(cpr::Parameters{});
+		if (req.compress)
+			session->SetAcceptEncoding(cpr::AcceptEncoding{});
+		else
+			session->SetAcceptEncoding(cpr::AcceptEncoding{{cpr::AcceptEncodingMethods::disabled}});
+		// Sessions belong to the calling thread, so its current token is the
+		// one to watch; curl aborts the transfer once this returns false.
+		session->SetProgressCallback(cpr::ProgressCallback{
+			[](auto, auto, auto, auto, intptr_t) { return !Threading::cancelled(); }
+		});
+
+		cpr::Response r;
+		if (req.method == "POST") {
+			session->SetBody(cpr::Body{req.body});
+			r = session->Post();
+		} else {
+			r = session->Get();
+		}
+		SessionPool::instance().recordTransfer(*session);
+		if (r.error.code != cpr::ErrorCode::OK)
+			session.discard();
+		if (r.error.code != cpr::ErrorCode::OK && Threading::cancelled())
+			return cancelledResponse();
+		Response resp = toResponse(r);
+		Transport::instance().record(req, resp, r.elapsed * 1000.0);
+		return resp;
+	}
+
+	inline SingleFlight<Response> &inflightRequests() {
+		static SingleFlight<Response> flights;
+		return flights;
+	}
+
+	// Identity used to join duplicate requests: only GETs are coalesced, and
+	// only when the headers that change the answer (who is asking, what format)
+	// match too. Returns empty for requests that must always go out.
+	inline string coalesceKey(const Request &req) {
+		if (req.method != "GET" || !req.coalesce)
+			return {};
+		string key = req.url;
+		for (const char *name: {"Cookie", "Accept", "Authorization"}) {
+			auto it = req.headers.find(name);
+			if (it != req.headers.end())
+				key += string("\n") + name + ": " + it->second;
+		}
+		if (!req.compress)
+			key += "\nidentity";
+		return key;
+	}
+
+	// Waits for the host's rate limiter, sends, and re-queues on 429.
+	inline Response performThrottled(const Request &req, bool allowFailover = true) {
+		auto &metrics = Metrics::instance();
+		const string endpoint = endpointName(req);
+		auto &transport = Transport::instance();
+		if (transport.replaying()) {
+			metrics.begin(endpoint);
+			std::chrono::milliseconds latency;
+			Response resp = transport.replay(req, latency);
+			if (latency.count() > 0)
+				std::this_thread::sleep_for(latency);
+			metrics.end(endpoint, req, resp, static_cast<double>(latency.count()));
+			return resp;
+		}
+
+		auto &limiter = RateLimiter::instance();
+		Response resp;
+		for (int attempt = 0; ; ++attempt) {
+			limiter.acquire(req.url);
+			// A cancelled request may have queued here for a while.
+			if (Threading::cancelled()) {
+				metrics.cancelled(endpoint);
+				return cancelledResponse();
+			}
+			metrics.begin(endpoint);
+			auto t0 = std::chrono::steady_clock::now();
+			resp = performOnce(req);
+			double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+			metrics.end(endpoint, req, resp, latencyMs);
+			if (resp.cancelled)
+				return resp; // says nothing about the host's health
+			Routes::Router::instance().report(req.url, resp.status_code, latencyMs);
+			if (resp.status_code == 0 && allowFailover && idempotent(req)) {
+				// Transport failure: try the same path once on another upstream of the pool.
+				if (auto alt = Routes::Router::instance().alternate(req.url)) {
+					Request retry = req;
+					retry.url = *alt;
+					metrics.retry(endpoint);
+					LOG_INFO("Failing over " + SessionPool::hostKey(req.url) + " -> " + SessionPool::hostKey(*alt));
+					return performThrottled(retry, false);
+				}
+			}
+			limiter.onResponse(req.url, resp.status_code, headerValue(resp, "Retry-After"));
+			if (resp.status_code != 429 || attempt >= kMaxThrottleRetries)
+				break;
+			metrics.retry(endpoint);
+			LOG_INFO("Throttled by " + SessionPool::hostKey(req.url) + ", retrying");
+		}
+		return resp;
+	}
+
+	// Recording and replay must see every exchange, so the cache only runs live.
+	inline bool useCache(const Request &req) {
+		return HttpCache::cacheable(req) && Transport::instance().mode() == TransportMode::Live;
+	}
+
+	// Answers from the response cache when it can, otherwise revalidates or
+	// fetches over the network and stores the result.
+	inline Response fetchCached(const Request &req) {
+		if (Threading::cancelled()) {
+			Metrics::instance().cancelled(endpointName(req));
+			return cancelledResponse();
+		}
+		auto &cache = HttpCache::instance();
+		if (!useCache(req))
+			return performThrottled(req);
+		if (auto hit = cache.lookup(req)) {
+			Metrics::instance().cacheHit(endpointName(req));
+			return *hit;
+		}
+		Request conditional = req;
+		if (!cache.addValidators(conditional))
+			return cache.update(req, performThrottled(req));
+		Response resp = cache.update(req, performThrottled(conditional));
+		// Not modified, but the copy it refers to is gone: fetch the body once.
+		if (resp.status_code == 304)
+			resp = cache.update(req, performThrottled(req));
+		return resp;
+	}
+
+	// Entry point for blocking requests; identical in-flight GETs share one call.
+	// Inside scoped work (Threading::TaskScope) the request is skipped or
+	// aborted once the scope is reset, and comes back with `cancelled` set.
+	inline Response perform(const Request &req) {
+		string key = coalesceKey(req);
+		if (key.empty())
+			return fetchCached(req);
+		Response resp = inflightRequests().run(key, [&req] { return fetchCached(req); });
+		// The call we joined belonged to a scope that was reset; ours wasn't.
+		if (resp.cancelled && !Threading::cancelled())
+			return fetchCached(req);
+		return resp;
+	}
+
 	inline Response get(
 		const std::string &url,
 		std::initializer_list<std::pair<const std::string, std::string> > headers = {},
 		cpr::Parameters params = {}
 	) {
-		auto r = cpr::Get(
-			cpr::Url{url},
-			cpr::Header{headers},
-			params // <-- directly pass it
-		);
-		std::map<std::string, std::string> hdrs(r.header.begin(), r.header.end());
-		return {r.status_code, r.text, hdrs};
+		return perform(makeGet(url, headers, params));
+	}
+
+	inline Response download(const string &url) {
+		return perform(makeDownload(url));
 	}
 
 	inline Response post(
@@ -51,31 +279,7 @@ namespace HttpClient {
 		const string &jsonBody = string(),
 		initializer_list<pair<const string, string> > form = {}
 	) {
-		cpr::Header h{headers};
-		cpr::Response r;
-		if (!jsonBody.empty()) {
-			h["Content-Type"] = "application/json";
-			r = cpr::Post(
-				cpr::Url{url},
-				h,
-				cpr::Body{jsonBody}
-			);
-		} else if (form.size() > 0) {
-			string body = build_kv_string(form);
-			h["Content-Type"] = "application/x-www-form-urlencoded";
-			r = cpr::Post(
-				cpr::Url{url},
-				h,
-				cpr::Body{body}
-			);
-		} else {
-			r = cpr::Post(
-				cpr::Url{url},
-				h
-			);
-		}
-		map<string, string> hdrs(r.header.begin(), r.header.end());
-		return {r.status_code, r.text, hdrs};
+		return perform(makePost(url, headers, jsonBody, form));
 	}
 
 
@@ -0,0 +1,467 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+#include "http.hpp"
+#include "system/task.h"
+
+namespace HttpClient {
+	using Callback = std::function<void(Response)>;
+
+	// Event-driven HTTP client: every transfer runs on a single I/O thread that
+	// drives a curl multi handle, so hundreds of requests can be in flight
+	// without a thread each. Completion callbacks run on that I/O thread (or
+	// inline on a fresh cache hit) and must stay short; hand UI work off with
+	// MainThread::Post.
+	//
+	// A transfer belongs to the submitting thread's current cancel token.
+	// Once that is cancelled the transfer is dropped before it starts or
+	// aborted in flight, and its callback gets a response with `cancelled`
+	// set. Callbacks run with the same token current, so postScoped and
+	// follow-up submits inside them stay in the scope.
+	class AsyncEngine {
+	public:
+		static AsyncEngine &instance() {
+			static AsyncEngine engine;
+			return engine;
+		}
+
+		void submit(Request req, Callback cb) {
+			Threading::CancelToken token = Threading::currentToken();
+			if (token.cancelled()) {
+				Metrics::instance().cancelled(endpointName(req));
+				cb(cancelledResponse());
+				return;
+			}
+
+			// Identical GETs already in flight (from either path) just wait for that one.
+			std::string key = coalesceKey(req);
+			if (!key.empty()) {
+				// If the call we end up sharing is cancelled by its own scope,
+				// go again under ours.
+				cb = [this, req, token, cb = std::move(cb)](Response r) mutable {
+					Threading::WithToken scoped(token);
+					if (r.cancelled && !token.cancelled())
+						submit(std::move(req), std::move(cb));
+					else
+						cb(std::move(r));
+				};
+				if (!inflightRequests().join(key, std::move(cb)))
+					return;
+				cb = [key](Response r) { inflightRequests().complete(key, r); };
+			}
+
+			// Fresh cache hits complete inline on the submitting thread.
+			if (useCache(req)) {
+				auto &cache = HttpCache::instance();
+				if (auto hit = cache.lookup(req)) {
+					Metrics::instance().cacheHit(endpointName(req));
+					cb(std::move(*hit));
+					return;
+				}
+				Request original = req;
+				bool conditional = cache.addValidators(req);
+				cb = [this, original = std::move(original), conditional, token, cb = std::move(cb)](Response r) {
+					Response resp = HttpCache::instance().update(original, std::move(r));
+					// Not modified, but the copy it refers to is gone: fetch the body once.
+					if (resp.status_code == 304 && conditional) {
+						enqueue(original, [original, cb](Response full) {
+							cb(HttpCache::instance().update(original, std::move(full)));
+						}, token);
+						return;
+					}
+					cb(std::move(resp));
+				};
+			}
+
+			enqueue(std::move(req), std::move(cb), std::move(token));
+		}
+
+		std::future<Response> submit(Request req) {
+			auto promise = std::make_shared<std::promise<Response> >();
+			auto fut = promise->get_future();
+			submit(std::move(req), [promise](Response r) { promise->set_value(std::move(r)); });
+			return fut;
+		}
+
+		std::future<Response> get(
+			const std::string &url,
+			std::initializer_list<std::pair<const std::string, std::string> > headers = {}) {
+			return submit(makeGet(url, headers));
+		}
+
+		void get(
+			const std::string &url,
+			std::initializer_list<std::pair<const std::string, std::string> > headers,
+			Callback cb) {
+			submit(makeGet(url, headers), std::move(cb));
+		}
+
+		std::future<Response> post(
+			const std::string &url,
+			std::initializer_list<std::pair<const std::string, std::string> > headers = {},
+			const std::string &jsonBody = std::string()) {
+			return submit(makePost(url, headers, jsonBody));
+		}
+
+		size_t inFlight() const { return inFlight_; }
+
+		~AsyncEngine() {
+			stop_ = true;
+			curl_multi_wakeup(multi_);
+			if (worker_.joinable())
+				worker_.join();
+			for (CURL *easy: spare_)
+				curl_easy_cleanup(easy);
+			curl_multi_cleanup(multi_);
+		}
+
+	private:
+		struct Transfer {
+			Request req;
+			Callback cb;
+			Response resp;
+			CURL *easy = nullptr;
+			curl_slist *headerList = nullptr;
+			RateLimiter::Clock::time_point notBefore{};
+			int attempts = 0;
+			bool failedOver = false;
+			bool queued = false;
+			std::optional<Response> canned; // replayed from a capture, never hits curl
+			std::string endpoint;
+			Threading::CancelToken token;
+			RateLimiter::Clock::time_point startedAt{};
+		};
+
+		static constexpr long kMaxHostConnections = 16;
+		static constexpr long kMaxTotalConnections = 64;
+		static constexpr size_t kMaxSpareHandles = 32;
+
+		AsyncEngine() {
+			curl_global_init(CURL_GLOBAL_DEFAULT);
+			multi_ = curl_multi_init();
+			curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, kMaxHostConnections);
+			curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, kMaxTotalConnections);
+			curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+		}
+
+		void ensureStarted() {
+			std::call_once(started_, [this] { worker_ = std::thread([this] { run(); }); });
+		}
+
+		// Takes a rate-limiter slot; the transfer is held back until it is due.
+		static void schedule(Transfer &t) {
+			auto wait = RateLimiter::instance().reserve(t.req.url);
+			t.notBefore = RateLimiter::Clock::now() + wait;
+			t.queued = wait > RateLimiter::Clock::duration::zero();
+			if (t.queued)
+				RateLimiter::instance().enterQueue();
+		}
+
+		// Hands a request to the I/O thread, past coalescing and the cache.
+		// Safe to call from the I/O thread itself.
+		void enqueue(Request req, Callback cb, Threading::CancelToken token) {
+			auto t = std::make_unique<Transfer>();
+			t->endpoint = endpointName(req);
+			t->req = std::move(req);
+			t->cb = std::move(cb);
+			t->token = std::move(token);
+			if (Transport::instance().replaying()) {
+				// Canned answers still go through the I/O thread so callers see
+				// the same threading and the recorded latency.
+				std::chrono::milliseconds latency;
+				t->canned = Transport::instance().replay(t->req, latency);
+				t->startedAt = RateLimiter::Clock::now();
+				t->notBefore = t->startedAt + latency;
+				Metrics::instance().begin(t->endpoint);
+			} else {
+				schedule(*t);
+			} {
+				std::lock_guard<std::mutex> lock(mtx_);
+				pending_.push_back(std::move(t));
+			}
+			++inFlight_;
+			ensureStarted();
+			curl_multi_wakeup(multi_);
+		}
+
+		static size_t onBody(char *data, size_t size, size_t count, void *user) {
+			auto *t = static_cast<Transfer *>(user);
+			t->resp.text.append(data, size * count);
+			return size * count;
+		}
+
+		// Non-zero makes curl abort the transfer with CURLE_ABORTED_BY_CALLBACK.
+		static int onProgress(void *user, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+			return static_cast<Transfer *>(user)->token.cancelled() ? 1 : 0;
+		}
+
+		static size_t onHeader(char *data, size_t size, size_t count, void *user) {
+			auto *t = static_cast<Transfer *>(user);
+			std::string line(data, size * count);
+			// A new status line means a redirect or 100-continue; only keep the final headers.
+			if (line.rfind("HTTP/", 0) == 0) {
+				t->resp.headers.clear();
+				return size * count;
+			}
+			auto colon = line.find(':');
+			if (colon == std::string::npos)
+				return size * count;
+			std::string name = line.substr(0, colon);
+			size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+			size_t valueEnd = line.find_last_not_of("\r\n");
+			std::string value = valueStart == std::string::npos || valueEnd < valueStart
+				                    ? std::string{}
+				                    : line.substr(valueStart, valueEnd - valueStart + 1);
+			t->resp.headers[name] = value;
+			return size * count;
+		}
+
+		void start(std::unique_ptr<Transfer> t) {
+			CURL *easy;
+			if (!spare_.empty()) {
+				easy = spare_.back();
+				spare_.pop_back();
+				curl_easy_reset(easy);
+			} else {
+				easy = curl_easy_init();
+			}
+			t->easy = easy;
+
+			curl_easy_setopt(easy, CURLOPT_URL, t->req.url.c_str());
+			curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+			curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+			curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, 15L);
+			curl_easy_setopt(easy, CURLOPT_TIMEOUT, 60L);
+			curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+			CurlShare::apply(easy);
+			// "" asks curl to advertise every encoding it was built with (gzip, deflate, br).
+			if (t->req.compress)
+				curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+			curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &AsyncEngine::onBody);
+			curl_easy_setopt(easy, CURLOPT_WRITEDATA, t.get());
+			curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &AsyncEngine::onHeader);
+			curl_easy_setopt(easy, CURLOPT_HEADERDATA, t.get());
+			curl_easy_setopt(easy, CURLOPT_PRIVATE, t.get());
+			if (t->token.cancellable()) {
+				curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, &AsyncEngine::onProgress);
+				curl_easy_setopt(easy, CURLOPT_XFERINFODATA, t.get());
+				curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+			}
+
+			for (const auto &[name, value]: t->req.headers)
+				t->headerList = curl_slist_append(t->headerList, (name + ": " + value).c_str());
+			if (t->headerList)
+				curl_easy_setopt(easy, CURLOPT_HTTPHEADER, t->headerList);
+
+			if (t->req.method == "POST") {
+				curl_easy_setopt(easy, CURLOPT_POST, 1L);
+				curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(t->req.body.size()));
+				curl_easy_setopt(easy, CURLOPT_POSTFIELDS, t->req.body.c_str());
+			}
+
+			Metrics::instance().begin(t->endpoint);
+			t->startedAt = RateLimiter::Clock::now();
+			curl_multi_add_handle(multi_, easy);
+			active_.push_back(std::move(t));
+		}
+
+		void finish(CURL *easy, CURLcode result) {
+			Transfer *raw = nullptr;
+			curl_easy_getinfo(easy, CURLINFO_PRIVATE, &raw);
+			auto it = std::find_if(active_.begin(), active_.end(),
+			                       [raw](const std::unique_ptr<Transfer> &p) { return p.get() == raw; });
+			if (it == active_.end())
+				return;
+			std::unique_ptr<Transfer> t = std::move(*it);
+			active_.erase(it);
+
+			long code = 0;
+			if (result == CURLE_OK)
+				curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+			t->resp.status_code = static_cast<int>(code);
+			curl_off_t wireBytes = 0;
+			curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &wireBytes);
+			noteBodySize(t->resp, static_cast<size_t>(wireBytes));
+			curl_off_t totalUs = 0;
+			curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &totalUs);
+
+			curl_multi_remove_handle(multi_, easy);
+			curl_slist_free_all(t->headerList);
+			t->headerList = nullptr;
+			t->easy = nullptr;
+			if (spare_.size() < kMaxSpareHandles)
+				spare_.push_back(easy);
+			else
+				curl_easy_cleanup(easy);
+
+			if (result == CURLE_ABORTED_BY_CALLBACK) {
+				// Cancelled by its scope: nothing to learn about the host.
+				t->resp = cancelledResponse();
+				Metrics::instance().end(t->endpoint, t->req, t->resp, static_cast<double>(totalUs) / 1000.0);
+				deliver(std::move(t));
+				return;
+			}
+			Transport::instance().record(t->req, t->resp, static_cast<double>(totalUs) / 1000.0);
+			Metrics::instance().end(t->endpoint, t->req, t->resp, static_cast<double>(totalUs) / 1000.0);
+			Routes::Router::instance().report(t->req.url, t->resp.status_code, static_cast<double>(totalUs) / 1000.0);
+
+			auto &limiter = RateLimiter::instance();
+			limiter.onResponse(t->req.url, t->resp.status_code, headerValue(t->resp, "Retry-After"));
+			if (t->resp.status_code == 0 && !t->failedOver && idempotent(t->req)) {
+				if (auto alt = Routes::Router::instance().alternate(t->req.url)) {
+					t->failedOver = true;
+					t->req.url = *alt;
+					t->resp = Response{};
+					Metrics::instance().retry(t->endpoint);
+					schedule(*t);
+					delayed_.push_back(std::move(t));
+					return;
+				}
+			}
+			if (t->resp.status_code == 429 && t->attempts < kMaxThrottleRetries) {
+				++t->attempts;
+				Metrics::instance().retry(t->endpoint);
+				t->resp = Response{};
+				schedule(*t);
+				delayed_.push_back(std::move(t));
+				return;
+			}
+			deliver(std::move(t));
+		}
+
+		void deliver(std::unique_ptr<Transfer> t) {
+			--inFlight_;
+			Threading::WithToken scoped(t->token);
+			if (t->cb) {
+				try {
+					t->cb(std::move(t->resp));
+				} catch (const std::exception &e) {
+					LOG_ERROR(std::string("Async HTTP callback threw: ") + e.what());
+				}
+			}
+		}
+
+		void startDue() {
+			auto now = RateLimiter::Clock::now();
+			for (auto it = delayed_.begin(); it != delayed_.end();) {
+				// Cancelled transfers leave the queue straight away rather than when due.
+				if ((*it)->notBefore > now && !(*it)->token.cancelled()) {
+					++it;
+					continue;
+				}
+				if ((*it)->queued)
+					RateLimiter::instance().leaveQueue();
+				auto t = std::move(*it);
+				it = delayed_.erase(it);
+				if (t->token.cancelled()) {
+					t->resp = cancelledResponse();
+					if (t->canned)
+						Metrics::instance().end(t->endpoint, t->req, t->resp, 0); // begun at submit
+					else
+						Metrics::instance().cancelled(t->endpoint);
+					deliver(std::move(t));
+				} else if (t->canned) {
+					t->resp = std::move(*t->canned);
+					Metrics::instance().end(t->endpoint, t->req, t->resp,
+					                        std::chrono::duration<double, std::milli>(now - t->startedAt).count());
+					deliver(std::move(t));
+				} else {
+					start(std::move(t));
+				}
+			}
+		}
+
+		// Sleep until the next delayed transfer is due, or at most a second.
+		int pollTimeoutMs() const {
+			auto now = RateLimiter::Clock::now();
+			long long timeout = 1000;
+			for (const auto &t: delayed_) {
+				auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t->notBefore - now).count() + 1;
+				timeout = std::min(timeout, std::max(0LL, static_cast<long long>(ms)));
+			}
+			return static_cast<int>(timeout);
+		}
+
+		void run() {
+			while (!stop_) {
+				std::deque<std::unique_ptr<Transfer> > incoming; {
+					std::lock_guard<std::mutex> lock(mtx_);
+					incoming.swap(pending_);
+				}
+				for (auto &t: incoming)
+					delayed_.push_back(std::move(t));
+
+				startDue();
+
+				int running = 0;
+				curl_multi_perform(multi_, &running);
+
+				int left = 0;
+				while (CURLMsg *msg = curl_multi_info_read(multi_, &left)) {
+					if (msg->msg == CURLMSG_DONE)
+						finish(msg->easy_handle, msg->data.result);
+				}
+
+				curl_multi_poll(multi_, nullptr, 0, pollTimeoutMs(), nullptr);
+			}
+		}
+
+		CURLM *multi_ = nullptr;
+		std::thread worker_;
+		std::once_flag started_;
+		std::atomic<bool> stop_{false};
+		std::atomic<size_t> inFlight_{0};
+
+		std::mutex mtx_;
+		std::deque<std::unique_ptr<Transfer> > pending_;
+
+		// Only touched from the I/O thread.
+		std::vector<std::unique_ptr<Transfer> > active_;
+		std::vector<CURL *> spare_;
+		// Transfers waiting for their rate-limiter slot.
+		std::vector<std::unique_ptr<Transfer> > delayed_;
+	};
+
+	// co_await fetch(req) from an Async::Task: the request goes through the
+	// AsyncEngine and the flow picks up again on a pool worker once the
+	// response is in, never on the I/O thread. Cancellation works as for
+	// submit().
+	class Fetch {
+	public:
+		explicit Fetch(Request req) : req_(std::move(req)) {}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> h) {
+			AsyncEngine::instance().submit(std::move(req_), [this, h, ctx = Async::Context::current()](Response r) {
+				resp_ = std::move(r);
+				Async::resumeOnPool("http.resume", h, ctx);
+			});
+		}
+
+		Response await_resume() { return std::move(resp_); }
+
+	private:
+		Request req_;
+		Response resp_;
+	};
+
+	inline Fetch fetch(Request req) {
+		return Fetch(std::move(req));
+	}
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <windows.h>
+#include <tlhelp32.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "http_async.h"
+#include "stub_server.h"
+#include "capture_server.h"
+#include "core/logging.hpp"
+
+// Side-by-side timing of blocking requests on the worker pool against the
+// async engine, both talking to a loopback stub server so results are
+// repeatable. Both sides go through the same stack (limiter, cache, metrics)
+// with coalescing off, so each side sends every request.
+namespace HttpBench {
+	inline int processThreadCount() {
+		HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+		if (snap == INVALID_HANDLE_VALUE)
+			return 0;
+		DWORD pid = GetCurrentProcessId();
+		THREADENTRY32 te{};
+		te.dwSize = sizeof(te);
+		int count = 0;
+		if (Thread32First(snap, &te)) {
+			do {
+				if (te.th32OwnerProcessID == pid)
+					++count;
+			} while (Thread32Next(snap, &te));
+		}
+		CloseHandle(snap);
+		return count;
+	}
+
+	struct Result {
+		double wallMs = 0;
+		int peakThreads = 0;
+		int failures = 0;
+	};
+
+	// Runs `work` while sampling the process thread count every few milliseconds.
+	template<typename Work>
+	Result measure(Work &&work) {
+		std::atomic<bool> sampling{true};
+		std::atomic<int> peak{processThreadCount()};
+		std::thread sampler([&] {
+			while (sampling) {
+				int n = processThreadCount();
+				if (n > peak)
+					peak = n;
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+		});
+
+		auto t0 = std::chrono::steady_clock::now();
+		int failures = work();
+		auto t1 = std::chrono::steady_clock::now();
+
+		sampling = false;
+		sampler.join();
+		return {std::chrono::duration<double, std::milli>(t1 - t0).count(), peak.load(), failures};
+	}
+
+	inline void RunAsyncVsThreads(int requests = 300, int serverDelayMs = 50) {
+		StubServer::Server server;
+		bool started = server.start([serverDelayMs](const StubServer::Request &) {
+			StubServer::Response r;
+			r.body = R"({"data":[{"id":1,"name":"stub"}]})";
+			r.delayMs = serverDelayMs;
+			return r;
+		});
+		if (!started) {
+			LOG_ERROR("HTTP benchmark: could not start stub server");
+			return;
+		}
+		HttpClient::Request req = HttpClient::makeGet(server.baseUrl() + "/v1/bench");
+		req.coalesce = false;
+		LOG_INFO("HTTP benchmark: " + std::to_string(requests) + " requests, " + std::to_string(serverDelayMs) +
+			"ms server latency, stub at " + server.baseUrl());
+
+		Result blocking = measure([&] {
+			std::vector<std::future<int> > statuses;
+			statuses.reserve(requests);
+			for (int i = 0; i < requests; ++i) {
+				auto status = std::make_shared<std::promise<int> >();
+				statuses.push_back(status->get_future());
+				Threading::background("bench.blocking", [req, status] {
+					status->set_value(HttpClient::perform(req).status_code);
+				});
+			}
+			int failures = 0;
+			for (auto &s: statuses) {
+				Threading::wait(s);
+				if (s.get() != 200)
+					++failures;
+			}
+			return failures;
+		});
+
+		Result async = measure([&] {
+			std::vector<std::future<HttpClient::Response> > futures;
+			futures.reserve(requests);
+			for (int i = 0; i < requests; ++i)
+				futures.push_back(HttpClient::AsyncEngine::instance().submit(req));
+			int failures = 0;
+			for (auto &f: futures) {
+				if (f.get().status_code != 200)
+					++failures;
+			}
+			return failures;
+		});
+
+		server.stop();
+
+		auto report = [](const char *name, const Result &r) {
+			char buf[256];
+			snprintf(buf, sizeof(buf), "HTTP benchmark [%s]: %.1f ms wall, peak %d threads, %d failures",
+			         name, r.wallMs, r.peakThreads, r.failures);
+			LOG_INFO(buf);
+		};
+		report("blocking on pool", blocking);
+		report("async engine", async);
+	}
+
+	// Replays every exchange in a capture file against the loopback stub,
+	// once with the recorded latency and once without, through the async
+	// engine. Nothing leaves the machine.
+	inline void RunCaptureReplay(const std::string &capturePath) {
+		auto capture = std::make_shared<HttpClient::Capture>();
+		if (!capture->load(capturePath) || capture->size() == 0) {
+			LOG_INFO("Capture replay: nothing to replay in " + capturePath + " (record one first)");
+			return;
+		}
+		auto exchanges = capture->all();
+		LOG_INFO("Capture replay: " + std::to_string(exchanges.size()) + " exchanges from " + capturePath);
+
+		for (bool withLatency: {true, false}) {
+			StubServer::Server server;
+			if (!server.start(StubServer::captureHandler(capture, withLatency))) {
+				LOG_ERROR("Capture replay: could not start stub server");
+				return;
+			}
+
+			Result r = measure([&] {
+				std::vector<std::future<HttpClient::Response> > futures;
+				futures.reserve(exchanges.size());
+				for (const auto &e: exchanges) {
+					HttpClient::Request req;
+					req.method = e.method;
+					req.url = StubServer::stubUrlFor(server, e.url);
+					req.body = e.requestBody;
+					req.coalesce = false;
+					futures.push_back(HttpClient::AsyncEngine::instance().submit(std::move(req)));
+				}
+				int failures = 0;
+				for (size_t i = 0; i < futures.size(); ++i) {
+					if (futures[i].get().status_code != exchanges[i].status)
+						++failures;
+				}
+				return failures;
+			});
+			server.stop();
+
+			char buf[256];
+			snprintf(buf, sizeof(buf), "Capture replay [%s]: %.1f ms wall, peak %d threads, %d mismatched statuses",
+			         withLatency ? "recorded latency" : "no latency", r.wallMs, r.peakThreads, r.failures);
+			LOG_INFO(buf);
+		}
+	}
+}
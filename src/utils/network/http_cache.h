@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "http_types.h"
+#include "core/hash.h"
+#include "core/logging.hpp"
+
+namespace HttpClient {
+	struct CacheStats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t revalidated = 0; // 304s answered from the stored body
+		uint64_t stored = 0;
+		uint64_t evictions = 0;
+		size_t entries = 0;
+		uint64_t bytes = 0;
+	};
+
+	inline std::string describe(const CacheStats &s) {
+		return std::to_string(s.hits) + " hits, " + std::to_string(s.misses) + " misses, " +
+		       std::to_string(s.revalidated) + " revalidated, " + std::to_string(s.evictions) + " evicted, " +
+		       std::to_string(s.entries) + " entries (" + std::to_string(s.bytes / 1024) + " KiB)";
+	}
+
+	// Disk-backed cache for anonymous GETs. Honours Cache-Control (max-age,
+	// no-cache, no-store, private), keeps ETag/Last-Modified so stale entries
+	// are revalidated with conditional requests, and evicts least recently used
+	// files once the directory grows past its cap. Requests carrying a cookie
+	// are never cached: their answers are per-account and must not hit disk.
+	//
+	// Each entry is one file: a JSON metadata line followed by the raw body.
+	class HttpCache {
+	public:
+		static HttpCache &instance() {
+			static HttpCache cache;
+			return cache;
+		}
+
+		// Points the cache at `dir` and indexes whatever a previous run left there.
+		void open(const std::string &dir, uint64_t maxBytes = 64ull * 1024 * 1024) {
+			namespace fs = std::filesystem;
+			std::lock_guard<std::mutex> lock(mtx_);
+			dir_ = dir;
+			maxBytes_ = maxBytes;
+			entries_.clear();
+			lru_.clear();
+			totalBytes_ = 0;
+
+			std::error_code ec;
+			fs::create_directories(dir_, ec);
+			if (ec) {
+				LOG_INFO("HTTP cache disabled, cannot create " + dir_ + ": " + ec.message());
+				dir_.clear();
+				return;
+			}
+
+			struct Found {
+				fs::file_time_type touched;
+				std::string key;
+				Entry entry;
+			};
+			std::vector<Found> found;
+			for (const auto &file: fs::directory_iterator(dir_, ec)) {
+				if (file.path().extension() != ".cache")
+					continue;
+				std::ifstream in(file.path(), std::ios::binary);
+				std::string line;
+				if (!std::getline(in, line))
+					continue;
+				try {
+					auto meta = nlohmann::json::parse(line);
+					Found f;
+					f.key = meta.value("key", "");
+					f.entry = entryFromMeta(meta);
+					f.entry.file = file.path().filename().string();
+					f.entry.size = file.file_size(ec);
+					f.touched = file.last_write_time(ec);
+					if (!f.key.empty())
+						found.push_back(std::move(f));
+				} catch (const std::exception &) {
+					fs::remove(file.path(), ec);
+				}
+			}
+
+			// Oldest first, so the most recently used end up at the front.
+			std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) { return a.touched < b.touched; });
+			for (auto &f: found) {
+				lru_.push_front(f.key);
+				f.entry.lru = lru_.begin();
+				totalBytes_ += f.entry.size;
+				entries_[f.key] = std::move(f.entry);
+			}
+			evictLocked();
+			LOG_INFO("HTTP cache: " + std::to_string(entries_.size()) + " entries (" +
+				std::to_string(totalBytes_ / 1024) + " KiB) in " + dir_);
+		}
+
+		static bool cacheable(const Request &req) {
+			return req.method == "GET" && req.headers.find("Cookie") == req.headers.end() &&
+			       req.headers.find("Authorization") == req.headers.end();
+		}
+
+		// Returns the stored response if it is still fresh.
+		std::optional<Response> lookup(const Request &req) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = dir_.empty() ? entries_.end() : entries_.find(keyFor(req));
+			if (it == entries_.end() || it->second.expiresAt <= now()) {
+				++misses_;
+				return std::nullopt;
+			}
+			auto resp = loadLocked(it);
+			if (!resp) {
+				++misses_;
+				return std::nullopt;
+			}
+			++hits_;
+			return resp;
+		}
+
+		// Adds If-None-Match / If-Modified-Since when a stale copy is on disk.
+		// Returns whether the request became conditional.
+		bool addValidators(Request &req) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = entries_.find(keyFor(req));
+			if (it == entries_.end())
+				return false;
+			if (!it->second.etag.empty())
+				req.headers["If-None-Match"] = it->second.etag;
+			if (!it->second.lastModified.empty())
+				req.headers["If-Modified-Since"] = it->second.lastModified;
+			return !it->second.etag.empty() || !it->second.lastModified.empty();
+		}
+
+		// Folds a network response into the cache. A 304 is turned back into the
+		// stored 200; other responses are stored when their headers allow it.
+		// A 304 comes back unchanged if the stored copy was evicted or its file
+		// went missing meanwhile; callers then re-send without validators.
+		Response update(const Request &req, Response resp) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if (dir_.empty())
+				return resp;
+			std::string key = keyFor(req);
+			auto it = entries_.find(key);
+
+			if (resp.status_code == 304 && it != entries_.end()) {
+				auto cached = loadLocked(it);
+				if (cached) {
+					++revalidated_;
+					Entry &e = it->second;
+					e.expiresAt = expiryFor(req, resp, now());
+					if (auto etag = headerValue(resp, "ETag"); !etag.empty())
+						e.etag = etag;
+					writeLocked(key, e, cached->text);
+					return *cached;
+				}
+			}
+
+			if (resp.status_code != 200)
+				return resp;
+			std::string cc = lower(headerValue(resp, "Cache-Control"));
+			if (cc.find("no-store") != std::string::npos || cc.find("private") != std::string::npos)
+				return resp;
+			if (resp.text.size() > maxBytes_ / 8)
+				return resp;
+
+			Entry e;
+			e.status = resp.status_code;
+			e.etag = headerValue(resp, "ETag");
+			e.lastModified = headerValue(resp, "Last-Modified");
+			e.contentType = headerValue(resp, "Content-Type");
+			e.expiresAt = expiryFor(req, resp, now());
+			if (e.expiresAt <= now() && e.etag.empty() && e.lastModified.empty())
+				return resp; // nothing to reuse it with
+
+			if (it != entries_.end())
+				removeLocked(it);
+			e.file = toHex(fnv1a64(key)) + ".cache";
+			if (writeLocked(key, e, resp.text)) {
+				lru_.push_front(key);
+				e.lru = lru_.begin();
+				e.size = resp.text.size();
+				totalBytes_ += e.size;
+				entries_[key] = std::move(e);
+				++stored_;
+				evictLocked();
+			}
+			return resp;
+		}
+
+		CacheStats stats() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			CacheStats s;
+			s.hits = hits_;
+			s.misses = misses_;
+			s.revalidated = revalidated_;
+			s.stored = stored_;
+			s.evictions = evictions_;
+			s.entries = entries_.size();
+			s.bytes = totalBytes_;
+			return s;
+		}
+
+	private:
+		struct Entry {
+			std::string file;
+			uint64_t size = 0;
+			int status = 200;
+			std::string etag;
+			std::string lastModified;
+			std::string contentType;
+			int64_t expiresAt = 0; // unix seconds
+			std::list<std::string>::iterator lru;
+		};
+
+		using EntryMap = std::unordered_map<std::string, Entry>;
+
+		HttpCache() = default;
+
+		static int64_t now() {
+			return std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		static std::string lower(std::string s) {
+			std::transform(s.begin(), s.end(), s.begin(),
+			               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return s;
+		}
+
+		// The same URL can be negotiated into different representations.
+		static std::string keyFor(const Request &req) {
+			auto accept = req.headers.find("Accept");
+			return accept == req.headers.end() ? req.url : req.url + "\n" + accept->second;
+		}
+
+		static int64_t expiryFor(const Request &req, const Response &resp, int64_t t) {
+			std::string cc = lower(headerValue(resp, "Cache-Control"));
+			if (cc.empty())
+				return t + req.cacheTtlSeconds;
+			if (cc.find("no-cache") != std::string::npos)
+				return t;
+			auto pos = cc.find("max-age=");
+			if (pos == std::string::npos)
+				return t + req.cacheTtlSeconds;
+			try {
+				return t + std::stoll(cc.substr(pos + 8));
+			} catch (const std::exception &) {
+				return t;
+			}
+		}
+
+		static Entry entryFromMeta(const nlohmann::json &meta) {
+			Entry e;
+			e.status = meta.value("status", 200);
+			e.etag = meta.value("etag", "");
+			e.lastModified = meta.value("lastModified", "");
+			e.contentType = meta.value("contentType", "");
+			e.expiresAt = meta.value("expiresAt", int64_t{0});
+			return e;
+		}
+
+		std::optional<Response> loadLocked(EntryMap::iterator it) {
+			namespace fs = std::filesystem;
+			fs::path path = fs::path(dir_) / it->second.file;
+			std::ifstream in(path, std::ios::binary);
+			std::string meta;
+			if (!in || !std::getline(in, meta)) {
+				removeLocked(it);
+				return std::nullopt;
+			}
+			std::ostringstream body;
+			body << in.rdbuf();
+
+			Response resp;
+			resp.status_code = it->second.status;
+			resp.text = body.str();
+			if (!it->second.contentType.empty())
+				resp.headers["Content-Type"] = it->second.contentType;
+			if (!it->second.etag.empty())
+				resp.headers["ETag"] = it->second.etag;
+			resp.uncompressed_bytes = resp.text.size();
+			resp.from_cache = true;
+
+			lru_.splice(lru_.begin(), lru_, it->second.lru);
+			std::error_code ec;
+			fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+			return resp;
+		}
+
+		bool writeLocked(const std::string &key, const Entry &e, const std::string &body) {
+			namespace fs = std::filesystem;
+			nlohmann::json meta = {
+				{"key", key},
+				{"status", e.status},
+				{"etag", e.etag},
+				{"lastModified", e.lastModified},
+				{"contentType", e.contentType},
+				{"expiresAt", e.expiresAt},
+			};
+			fs::path path = fs::path(dir_) / e.file;
+			fs::path tmp = path;
+			tmp += ".tmp";
+			{
+				std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+				if (!out)
+					return false;
+				out << meta.dump() << '\n';
+				out.write(body.data(), static_cast<std::streamsize>(body.size()));
+				if (!out)
+					return false;
+			}
+			std::error_code ec;
+			fs::rename(tmp, path, ec);
+			return !ec;
+		}
+
+		void removeLocked(EntryMap::iterator it) {
+			std::error_code ec;
+			std::filesystem::remove(std::filesystem::path(dir_) / it->second.file, ec);
+			totalBytes_ -= std::min(totalBytes_, it->second.size);
+			lru_.erase(it->second.lru);
+			entries_.erase(it);
+		}
+
+		void evictLocked() {
+			while (totalBytes_ > maxBytes_ && !lru_.empty()) {
+				auto it = entries_.find(lru_.back());
+				if (it == entries_.end()) {
+					lru_.pop_back();
+					continue;
+				}
+				removeLocked(it);
+				++evictions_;
+			}
+		}
+
+		mutable std::mutex mtx_;
+		std::string dir_;
+		uint64_t maxBytes_ = 0;
+		uint64_t totalBytes_ = 0;
+		EntryMap entries_;
+		std::list<std::string> lru_; // front = most recently used
+
+		uint64_t hits_ = 0;
+		uint64_t misses_ = 0;
+		uint64_t revalidated_ = 0;
+		uint64_t stored_ = 0;
+		uint64_t evictions_ = 0;
+	};
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "http_types.h"
+#include "core/hash.h"
+
+namespace HttpClient {
+	// One recorded request/response pair. Request headers are not kept (they
+	// carry cookies); the response keeps only the headers in capturedHeader,
+	// so no session cookie, CSRF token or auth ticket reaches the file.
+	struct Exchange {
+		std::string method;
+		std::string url;
+		std::string requestBody;
+		int status = 0;
+		std::map<std::string, std::string> headers;
+		std::string body;
+		double latencyMs = 0;
+	};
+
+	// JSON strings must be UTF-8, so binary bodies (thumbnails) are stored base64.
+	inline std::string captureBase64Encode(const std::string &in) {
+		static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string out;
+		out.reserve((in.size() + 2) / 3 * 4);
+		size_t i = 0;
+		for (; i + 2 < in.size(); i += 3) {
+			uint32_t n = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8) | uint8_t(in[i + 2]);
+			out += table[(n >> 18) & 63];
+			out += table[(n >> 12) & 63];
+			out += table[(n >> 6) & 63];
+			out += table[n & 63];
+		}
+		if (i < in.size()) {
+			uint32_t n = uint8_t(in[i]) << 16;
+			if (i + 1 < in.size())
+				n |= uint8_t(in[i + 1]) << 8;
+			out += table[(n >> 18) & 63];
+			out += table[(n >> 12) & 63];
+			out += i + 1 < in.size() ? table[(n >> 6) & 63] : '=';
+			out += '=';
+		}
+		return out;
+	}
+
+	inline std::string captureBase64Decode(const std::string &in) {
+		auto value = [](char c) -> int {
+			if (c >= 'A' && c <= 'Z') return c - 'A';
+			if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+			if (c >= '0' && c <= '9') return c - '0' + 52;
+			if (c == '+') return 62;
+			if (c == '/') return 63;
+			return -1;
+		};
+		std::string out;
+		uint32_t buf = 0;
+		int bits = 0;
+		for (char c: in) {
+			int v = value(c);
+			if (v < 0)
+				continue;
+			buf = (buf << 6) | static_cast<uint32_t>(v);
+			bits += 6;
+			if (bits >= 8) {
+				bits -= 8;
+				out += static_cast<char>((buf >> bits) & 0xff);
+			}
+		}
+		return out;
+	}
+
+	inline bool isValidUtf8(const std::string &s) {
+		size_t i = 0;
+		while (i < s.size()) {
+			auto c = static_cast<unsigned char>(s[i]);
+			size_t len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 0;
+			if (len == 0 || i + len > s.size())
+				return false;
+			for (size_t k = 1; k < len; ++k) {
+				if ((static_cast<unsigned char>(s[i + k]) >> 6) != 0x2)
+					return false;
+			}
+			i += len;
+		}
+		return true;
+	}
+
+	inline nlohmann::json toJson(const Exchange &e) {
+		bool binary = !isValidUtf8(e.body);
+		return {
+			{"method", e.method},
+			{"url", e.url},
+			{"requestBody", e.requestBody},
+			{"status", e.status},
+			{"headers", e.headers},
+			{"body", binary ? captureBase64Encode(e.body) : e.body},
+			{"bodyEncoding", binary ? "base64" : "text"},
+			{"latencyMs", e.latencyMs},
+		};
+	}
+
+	inline Exchange exchangeFromJson(const nlohmann::json &j) {
+		Exchange e;
+		e.method = j.value("method", "GET");
+		e.url = j.value("url", "");
+		e.requestBody = j.value("requestBody", "");
+		e.status = j.value("status", 0);
+		e.headers = j.value("headers", std::map<std::string, std::string>{});
+		e.body = j.value("body", "");
+		if (j.value("bodyEncoding", "text") == "base64")
+			e.body = captureBase64Decode(e.body);
+		e.latencyMs = j.value("latencyMs", 0.0);
+		return e;
+	}
+
+	// A capture file is JSON Lines, one Exchange per line, so recording can
+	// append without rewriting and a crash loses at most the last line.
+	// Several exchanges may share a request; replay hands them out in
+	// recorded order and wraps around.
+	class Capture {
+	public:
+		bool load(const std::string &path) {
+			std::ifstream in(path);
+			if (!in)
+				return false;
+			std::lock_guard<std::mutex> lock(mtx_);
+			byRequest_.clear();
+			exchanges_.clear();
+			std::string line;
+			while (std::getline(in, line)) {
+				if (line.empty())
+					continue;
+				try {
+					addLocked(exchangeFromJson(nlohmann::json::parse(line)));
+				} catch (const std::exception &) {
+					// A truncated last line from an interrupted recording.
+				}
+			}
+			return true;
+		}
+
+		void add(Exchange e) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			addLocked(std::move(e));
+		}
+
+		// Next recorded answer for this request, if it was ever seen.
+		std::optional<Exchange> next(const std::string &method, const std::string &url, const std::string &body) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = byRequest_.find(requestKey(method, url, body));
+			if (it == byRequest_.end() || it->second.indices.empty())
+				return std::nullopt;
+			auto &slot = it->second;
+			Exchange e = exchanges_[slot.indices[slot.cursor]];
+			slot.cursor = (slot.cursor + 1) % slot.indices.size();
+			return e;
+		}
+
+		std::vector<Exchange> all() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return exchanges_;
+		}
+
+		size_t size() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return exchanges_.size();
+		}
+
+		static std::string requestKey(const std::string &method, const std::string &url, const std::string &body) {
+			return method + ' ' + url + ' ' + toHex(fnv1a64(body));
+		}
+
+	private:
+		struct Slot {
+			std::vector<size_t> indices;
+			size_t cursor = 0;
+		};
+
+		void addLocked(Exchange e) {
+			byRequest_[requestKey(e.method, e.url, e.requestBody)].indices.push_back(exchanges_.size());
+			exchanges_.push_back(std::move(e));
+		}
+
+		mutable std::mutex mtx_;
+		std::vector<Exchange> exchanges_;
+		std::unordered_map<std::string, Slot> byRequest_;
+	};
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "http_types.h"
+
+namespace HttpClient {
+	// Known API paths, matched on host substring + path prefix. Anything else
+	// falls back to "<service>.<last path word>", skipping versions and ids, so
+	// friends.roblox.com/v1/users/1/unfriend becomes "friends.unfriend".
+	struct EndpointPattern {
+		const char *host;
+		const char *pathPrefix;
+		const char *name;
+	};
+
+	inline constexpr EndpointPattern kEndpointPatterns[] = {
+		{"presence.", "/v1/presence/users", "presence.batch"},
+		{"auth.roblox.com", "/v1/authentication-ticket", "auth.ticket"},
+		{"thumbnails.", "/v1/assets", "thumbnails.assets"},
+		{"thumbnails.", "/v1/users/avatar", "thumbnails.avatar"},
+		{"users.", "/v1/users/authenticated", "users.authenticated"},
+		{"users.", "/v1/usernames/users", "users.byUsername"},
+		{"users.", "/v1/users", "users.info"},
+		{"usermoderation.", "/v1/not-approved", "moderation.notApproved"},
+		{"voice.", "/v1/settings", "voice.settings"},
+		{"games.", "/v1/games/", "games.servers"},
+		{"games.", "/v1/games", "games.detail"},
+		{"apis.roblox.com", "/search-api", "search.omni"},
+		{"api.github.com", "/repos", "github.release"},
+		{"rbxcdn.com", "", "cdn.download"},
+	};
+
+	inline std::string endpointName(const Request &req) {
+		if (!req.endpoint.empty())
+			return req.endpoint;
+
+		std::string url = req.url;
+		if (auto p = url.find("://"); p != std::string::npos)
+			url.erase(0, p + 3);
+		if (auto q = url.find_first_of("?#"); q != std::string::npos)
+			url.erase(q);
+		size_t slash = url.find('/');
+		std::string host = url.substr(0, slash);
+		std::string path = slash == std::string::npos ? "/" : url.substr(slash);
+		// Mock/stub routing puts the real host in the first path segment.
+		if (size_t next = path.find('/', 1); next != std::string::npos && path.find('.') < next) {
+			host = path.substr(1, next - 1);
+			path.erase(0, next);
+		}
+
+		for (const auto &p: kEndpointPatterns) {
+			if (host.find(p.host) != std::string::npos && path.rfind(p.pathPrefix, 0) == 0)
+				return p.name;
+		}
+
+		std::string service = host.substr(0, host.find('.'));
+		std::string word;
+		size_t pos = 1;
+		while (pos < path.size()) {
+			size_t end = path.find('/', pos);
+			std::string seg = path.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+			pos = end == std::string::npos ? path.size() : end + 1;
+			bool version = seg.size() >= 2 && seg[0] == 'v' && std::isdigit(static_cast<unsigned char>(seg[1]));
+			bool numeric = !seg.empty() && std::all_of(seg.begin(), seg.end(), [](unsigned char c) { return std::isdigit(c); });
+			if (!seg.empty() && !version && !numeric)
+				word = seg;
+		}
+		return word.empty() ? service : service + "." + word;
+	}
+
+	// Log-spaced latency buckets: four per doubling from 1 ms to ~55 s, so a
+	// percentile read from the histogram is within ~19% of the true value.
+	class LatencyHistogram {
+	public:
+		static constexpr int kBuckets = 64;
+
+		void add(double ms) {
+			++counts_[bucketFor(ms)];
+			++total_;
+		}
+
+		double percentile(double p) const {
+			if (total_ == 0)
+				return 0;
+			uint64_t target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(total_)));
+			uint64_t seen = 0;
+			for (int i = 0; i < kBuckets; ++i) {
+				seen += counts_[i];
+				if (seen >= target)
+					return upperBound(i);
+			}
+			return upperBound(kBuckets - 1);
+		}
+
+		uint64_t count() const { return total_; }
+
+	private:
+		static int bucketFor(double ms) {
+			if (ms <= 1)
+				return 0;
+			int b = static_cast<int>(std::ceil(std::log2(ms) * 4));
+			return std::clamp(b, 0, kBuckets - 1);
+		}
+
+		static double upperBound(int bucket) { return std::exp2(bucket / 4.0); }
+
+		std::array<uint64_t, kBuckets> counts_{};
+		uint64_t total_ = 0;
+	};
+
+	struct EndpointSnapshot {
+		std::string name;
+		uint64_t requests = 0;
+		uint64_t inFlight = 0;
+		uint64_t retries = 0;
+		uint64_t failures = 0; // no HTTP status (DNS, connect, timeout)
+		uint64_t cancelled = 0; // dropped or aborted by a task scope reset
+		uint64_t cacheHits = 0;
+		uint64_t bytesIn = 0;
+		uint64_t bytesOut = 0;
+		double p50 = 0, p95 = 0, p99 = 0, maxMs = 0;
+		std::map<int, uint64_t> statusCounts;
+	};
+
+	inline nlohmann::json toJson(const EndpointSnapshot &s) {
+		nlohmann::json statuses = nlohmann::json::object();
+		for (const auto &[code, n]: s.statusCounts)
+			statuses[std::to_string(code)] = n;
+		return {
+			{"endpoint", s.name},
+			{"requests", s.requests},
+			{"inFlight", s.inFlight},
+			{"retries", s.retries},
+			{"failures", s.failures},
+			{"cancelled", s.cancelled},
+			{"cacheHits", s.cacheHits},
+			{"bytesIn", s.bytesIn},
+			{"bytesOut", s.bytesOut},
+			{"latencyMs", {{"p50", s.p50}, {"p95", s.p95}, {"p99", s.p99}, {"max", s.maxMs}}},
+			{"statusCounts", statuses},
+		};
+	}
+
+	// Per-endpoint counters fed by every transport path (blocking, async,
+	// replay). Cheap enough to leave on: one short lock per finished request.
+	class Metrics {
+	public:
+		static Metrics &instance() {
+			static Metrics metrics;
+			return metrics;
+		}
+
+		void begin(const std::string &endpoint) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			++stats_[endpoint].inFlight;
+		}
+
+		void end(const std::string &endpoint, const Request &req, const Response &resp, double latencyMs) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto &s = stats_[endpoint];
+			if (s.inFlight > 0)
+				--s.inFlight;
+			if (resp.cancelled) {
+				++s.cancelled; // aborted mid-transfer; keep it out of the latency figures
+				return;
+			}
+			++s.requests;
+			s.bytesOut += req.body.size() + req.url.size();
+			s.bytesIn += resp.compressed_bytes ? resp.compressed_bytes : resp.text.size();
+			if (resp.status_code == 0)
+				++s.failures;
+			else
+				++s.statusCounts[resp.status_code];
+			s.latency.add(latencyMs);
+			s.maxMs = std::max(s.maxMs, latencyMs);
+		}
+
+		void retry(const std::string &endpoint) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			++stats_[endpoint].retries;
+		}
+
+		// A request dropped before it was sent.
+		void cancelled(const std::string &endpoint) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			++stats_[endpoint].cancelled;
+		}
+
+		void cacheHit(const std::string &endpoint) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			++stats_[endpoint].cacheHits;
+		}
+
+		std::vector<EndpointSnapshot> snapshot() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			std::vector<EndpointSnapshot> out;
+			out.reserve(stats_.size());
+			for (const auto &[name, s]: stats_) {
+				EndpointSnapshot e;
+				e.name = name;
+				e.requests = s.requests;
+				e.inFlight = s.inFlight;
+				e.retries = s.retries;
+				e.failures = s.failures;
+				e.cancelled = s.cancelled;
+				e.cacheHits = s.cacheHits;
+				e.bytesIn = s.bytesIn;
+				e.bytesOut = s.bytesOut;
+				e.p50 = s.latency.percentile(0.50);
+				e.p95 = s.latency.percentile(0.95);
+				e.p99 = s.latency.percentile(0.99);
+				e.maxMs = s.maxMs;
+				e.statusCounts = s.statusCounts;
+				out.push_back(std::move(e));
+			}
+			return out;
+		}
+
+		nlohmann::json snapshotJson() const {
+			nlohmann::json arr = nlohmann::json::array();
+			for (const auto &e: snapshot())
+				arr.push_back(toJson(e));
+			return arr;
+		}
+
+		void reset() {
+			std::lock_guard<std::mutex> lock(mtx_);
+			for (auto it = stats_.begin(); it != stats_.end();) {
+				// Keep in-flight counts honest for requests still running.
+				if (it->second.inFlight > 0) {
+					uint64_t inFlight = it->second.inFlight;
+					it->second = Stats{};
+					it->second.inFlight = inFlight;
+					++it;
+				} else {
+					it = stats_.erase(it);
+				}
+			}
+		}
+
+	private:
+		struct Stats {
+			uint64_t requests = 0;
+			uint64_t inFlight = 0;
+			uint64_t retries = 0;
+			uint64_t failures = 0;
+			uint64_t cancelled = 0;
+			uint64_t cacheHits = 0;
+			uint64_t bytesIn = 0;
+			uint64_t bytesOut = 0;
+			double maxMs = 0;
+			std::map<int, uint64_t> statusCounts;
+			LatencyHistogram latency;
+		};
+
+		Metrics() = default;
+
+		mutable std::mutex mtx_;
+		std::map<std::string, Stats> stats_;
+	};
+}
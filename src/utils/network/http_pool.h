@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cpr/cpr.h>
+#include <curl/curl.h>
+
+namespace HttpClient {
+	struct PoolStats {
+		uint64_t transfers = 0;
+		uint64_t newConnections = 0;
+		uint64_t reusedConnections = 0;
+		uint64_t sessionsCreated = 0;
+		uint64_t sessionsDropped = 0;
+		size_t idleSessions = 0;
+	};
+
+	inline std::string describe(const PoolStats &s) {
+		uint64_t pct = s.transfers ? (s.reusedConnections * 100 / s.transfers) : 0;
+		return std::to_string(s.transfers) + " transfers, " + std::to_string(s.reusedConnections) +
+		       " on reused connections (" + std::to_string(pct) + "%), " + std::to_string(s.newConnections) +
+		       " new connections, " + std::to_string(s.idleSessions) + " idle sessions";
+	}
+
+	// How long a resolved address is reused before curl asks DNS again.
+	inline constexpr long kDnsCacheSeconds = 300;
+
+	// One curl share handle for every easy handle in the process (pooled cpr
+	// sessions and the async engine), so a host resolved or TLS-handshaken on
+	// one path is cheap on the other.
+	class CurlShare {
+	public:
+		static CURLSH *handle() {
+			static CurlShare share;
+			return share.share_;
+		}
+
+		static void apply(CURL *easy) {
+			curl_easy_setopt(easy, CURLOPT_SHARE, handle());
+			curl_easy_setopt(easy, CURLOPT_DNS_CACHE_TIMEOUT, kDnsCacheSeconds);
+		}
+
+	private:
+		CurlShare() {
+			share_ = curl_share_init();
+			curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &CurlShare::lock);
+			curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &CurlShare::unlock);
+			curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+			curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+		}
+
+		~CurlShare() { curl_share_cleanup(share_); }
+
+		static void lock(CURL *, curl_lock_data data, curl_lock_access, void *user) {
+			static_cast<CurlShare *>(user)->locks_[data % kLockSlots].lock();
+		}
+
+		static void unlock(CURL *, curl_lock_data data, void *user) {
+			static_cast<CurlShare *>(user)->locks_[data % kLockSlots].unlock();
+		}
+
+		static constexpr int kLockSlots = CURL_LOCK_DATA_LAST;
+
+		CURLSH *share_ = nullptr;
+		std::mutex locks_[kLockSlots];
+	};
+
+	// Keeps cpr::Session handles alive between requests so libcurl can reuse the
+	// TCP/TLS connection it already has open to a host. Sessions are keyed by
+	// method + scheme://host:port; GET and POST never share a handle because cpr
+	// keeps the body on the session once it has been set.
+	class SessionPool {
+	public:
+		class Lease {
+		public:
+			Lease() = default;
+
+			Lease(SessionPool *pool, std::string key, std::unique_ptr<cpr::Session> session)
+				: pool_(pool), key_(std::move(key)), session_(std::move(session)) {
+			}
+
+			Lease(Lease &&other) noexcept = default;
+
+			Lease &operator=(Lease &&other) noexcept {
+				if (this != &other) {
+					release();
+					pool_ = other.pool_;
+					key_ = std::move(other.key_);
+					session_ = std::move(other.session_);
+				}
+				return *this;
+			}
+
+			Lease(const Lease &) = delete;
+
+			Lease &operator=(const Lease &) = delete;
+
+			~Lease() { release(); }
+
+			cpr::Session &operator*() const { return *session_; }
+			cpr::Session *operator->() const { return session_.get(); }
+
+			// Drop the handle instead of returning it, e.g. after a transport error.
+			void discard() {
+				if (session_ && pool_)
+					++pool_->sessionsDropped_;
+				session_.reset();
+			}
+
+		private:
+			void release() {
+				if (pool_ && session_)
+					pool_->giveBack(key_, std::move(session_));
+			}
+
+			SessionPool *pool_ = nullptr;
+			std::string key_;
+			std::unique_ptr<cpr::Session> session_;
+		};
+
+		static SessionPool &instance() {
+			static SessionPool pool;
+			return pool;
+		}
+
+		Lease acquire(const std::string &method, const std::string &url) {
+			std::string key = method + ' ' + hostKey(url); {
+				std::lock_guard<std::mutex> lock(mtx_);
+				auto it = idle_.find(key);
+				if (it != idle_.end() && !it->second.empty()) {
+					auto session = std::move(it->second.back());
+					it->second.pop_back();
+					return Lease(this, std::move(key), std::move(session));
+				}
+			}
+
+			auto session = std::make_unique<cpr::Session>();
+			CURL *handle = session->GetCurlHolder()->handle;
+			curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+			curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, kKeepAliveIdleSeconds);
+			curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, kKeepAliveIntervalSeconds);
+			CurlShare::apply(handle);
+			++sessionsCreated_;
+			return Lease(this, std::move(key), std::move(session));
+		}
+
+		// Called after every transfer so we know whether curl opened a new
+		// connection or reused one it already had for this host.
+		void recordTransfer(cpr::Session &session) {
+			long connects = 0;
+			curl_easy_getinfo(session.GetCurlHolder()->handle, CURLINFO_NUM_CONNECTS, &connects);
+			++transfers_;
+			if (connects > 0)
+				newConnections_ += connects;
+			else
+				++reusedConnections_;
+		}
+
+		void setMaxIdlePerHost(size_t n) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			maxIdlePerHost_ = n;
+			for (auto &[key, sessions]: idle_) {
+				while (sessions.size() > maxIdlePerHost_) {
+					sessions.pop_back();
+					++sessionsDropped_;
+				}
+			}
+		}
+
+		PoolStats stats() const {
+			PoolStats s;
+			s.transfers = transfers_;
+			s.newConnections = newConnections_;
+			s.reusedConnections = reusedConnections_;
+			s.sessionsCreated = sessionsCreated_;
+			s.sessionsDropped = sessionsDropped_;
+			std::lock_guard<std::mutex> lock(mtx_);
+			for (const auto &[key, sessions]: idle_)
+				s.idleSessions += sessions.size();
+			return s;
+		}
+
+		// "https://users.roblox.com/v1/users/1" -> "https://users.roblox.com:443"
+		static std::string hostKey(const std::string &url) {
+			std::string scheme = "https";
+			size_t hostStart = 0;
+			if (auto p = url.find("://"); p != std::string::npos) {
+				scheme = url.substr(0, p);
+				hostStart = p + 3;
+			}
+			size_t hostEnd = url.find_first_of("/?#", hostStart);
+			std::string host = url.substr(hostStart, hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+			if (auto at = host.rfind('@'); at != std::string::npos)
+				host.erase(0, at + 1);
+			std::transform(host.begin(), host.end(), host.begin(),
+			               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			std::transform(scheme.begin(), scheme.end(), scheme.begin(),
+			               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			if (host.find(':') == std::string::npos)
+				host += scheme == "http" ? ":80" : ":443";
+			return scheme + "://" + host;
+		}
+
+	private:
+		static constexpr long kKeepAliveIdleSeconds = 30;
+		static constexpr long kKeepAliveIntervalSeconds = 15;
+
+		SessionPool() = default;
+
+		void giveBack(const std::string &key, std::unique_ptr<cpr::Session> session) {
+			// cpr turns on curl's cookie engine, so Set-Cookie from this
+			// response would ride along on the next request through the
+			// handle, which may be for another account.
+			curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_COOKIELIST, "ALL");
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto &sessions = idle_[key];
+			if (sessions.size() >= maxIdlePerHost_) {
+				++sessionsDropped_;
+				return;
+			}
+			sessions.push_back(std::move(session));
+		}
+
+		mutable std::mutex mtx_;
+		std::unordered_map<std::string, std::vector<std::unique_ptr<cpr::Session> > > idle_;
+		size_t maxIdlePerHost_ = 8;
+
+		std::atomic<uint64_t> transfers_{0};
+		std::atomic<uint64_t> newConnections_{0};
+		std::atomic<uint64_t> reusedConnections_{0};
+		std::atomic<uint64_t> sessionsCreated_{0};
+		std::atomic<uint64_t> sessionsDropped_{0};
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <cpr/cpr.h>
+
+namespace HttpClient {
+	struct Response {
+		int status_code = 0;
+		std::string text;
+		std::map<std::string, std::string> headers;
+		// Body size as received on the wire and after content decoding.
+		size_t compressed_bytes = 0;
+		size_t uncompressed_bytes = 0;
+		std::string content_encoding;
+		// Served from the response cache (fresh hit or 304 revalidation).
+		bool from_cache = false;
+		// Never sent, or aborted mid-transfer, because the task scope that
+		// asked for it was reset. status_code is 0.
+		bool cancelled = false;
+	};
+
+	inline Response cancelledResponse() {
+		Response resp;
+		resp.cancelled = true;
+		return resp;
+	}
+
+	// Transport-independent description of a request. Both the blocking
+	// get/post helpers and the async engine are driven from this.
+	struct Request {
+		std::string method = "GET";
+		std::string url;
+		cpr::Header headers;
+		std::string body;
+		// Advertise gzip/deflate/br and let curl decode the body. Turn off for
+		// payloads that are already compressed (PNG thumbnails etc).
+		bool compress = true;
+		// Freshness assumed when the server sends no Cache-Control at all.
+		// Zero means such responses are only reused after revalidation.
+		int cacheTtlSeconds = 0;
+		// Logical name for metrics ("presence.batch"); derived from the URL when empty.
+		std::string endpoint;
+		// Join an identical GET already in flight. Benchmarks turn this off so
+		// every request they issue really goes out.
+		bool coalesce = true;
+	};
+
+	// Safe to send twice. A transport failure can come after the server got
+	// the request, so only these are retried on another upstream.
+	inline bool idempotent(const Request &req) {
+		return req.method == "GET" || req.method == "HEAD";
+	}
+
+	// Case-insensitive header lookup; servers are inconsistent about casing.
+	inline std::string headerValue(const Response &resp, const std::string &name) {
+		for (const auto &[key, value]: resp.headers) {
+			if (key.size() == name.size() &&
+			    std::equal(key.begin(), key.end(), name.begin(), [](char a, char b) {
+				    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+			    }))
+				return value;
+		}
+		return {};
+	}
+}
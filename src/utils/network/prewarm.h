@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+#include "http.hpp"
+#include "routes.h"
+#include "core/logging.hpp"
+
+// Startup stage that resolves every API host and opens a keep-alive
+// connection to it in parallel, while settings and accounts are still being
+// loaded. The first real requests then find DNS cached (shared via
+// CurlShare) and a warm pooled session instead of paying DNS + TCP + TLS one
+// host after another.
+namespace HttpClient {
+	struct PrewarmResult {
+		int hosts = 0;
+		int failures = 0;
+		double wallMs = 0;
+		double setupMs = 0; // sum of per-connection DNS+TCP+TLS time, i.e. the serial cost avoided
+	};
+
+	// Services the status refresh POSTs to get a warm POST-keyed session as
+	// well; everything else is only ever read with GET.
+	inline bool prewarmPost(Routes::Service s) {
+		return s == Routes::Service::Presence || s == Routes::Service::Auth || s == Routes::Service::Users;
+	}
+
+	// One warm-up transfer on a pooled session. The response itself does not
+	// matter (most API roots answer 404); the connection it leaves behind does.
+	inline double warmSession(const std::string &method, const std::string &base) {
+		auto session = SessionPool::instance().acquire(method, base);
+		session->SetUrl(cpr::Url{base + "/"});
+		session->SetHeader(cpr::Header{});
+		session->SetParameters(cpr::Parameters{});
+		cpr::Response r = session->Get();
+		SessionPool::instance().recordTransfer(*session);
+		if (r.error.code != cpr::ErrorCode::OK) {
+			session.discard();
+			return -1;
+		}
+		curl_off_t appConnectUs = 0;
+		curl_easy_getinfo(session->GetCurlHolder()->handle, CURLINFO_APPCONNECT_TIME_T, &appConnectUs);
+		return static_cast<double>(appConnectUs) / 1000.0;
+	}
+
+	inline PrewarmResult prewarmConnections() {
+		PrewarmResult result;
+		if (Transport::instance().replaying())
+			return result;
+
+		auto t0 = std::chrono::steady_clock::now();
+		std::vector<std::future<double> > warming;
+		for (size_t i = 0; i < Routes::kServices.size(); ++i) {
+			auto service = static_cast<Routes::Service>(i);
+			std::string base = Routes::Router::instance().base(service);
+			warming.push_back(std::async(std::launch::async, warmSession, std::string("GET"), base));
+			if (prewarmPost(service))
+				warming.push_back(std::async(std::launch::async, warmSession, std::string("POST"), base));
+			++result.hosts;
+		}
+		for (auto &f: warming) {
+			double ms = f.get();
+			if (ms < 0)
+				++result.failures;
+			else
+				result.setupMs += ms;
+		}
+		result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+		char buf[192];
+		snprintf(buf, sizeof(buf), "Prewarmed %d hosts (%zu connections, %d failed) in %.0f ms; %.0f ms of DNS/TCP/TLS setup overlapped",
+		         result.hosts, warming.size(), result.failures, result.wallMs, result.setupMs);
+		LOG_INFO(buf);
+		return result;
+	}
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "http_pool.h"
+#include "system/threading.h"
+
+namespace HttpClient {
+	struct LimiterStats {
+		size_t queued = 0;          // callers currently waiting for a token
+		size_t peakQueued = 0;
+		uint64_t delayed = 0;       // requests that had to wait at all
+		uint64_t throttleEvents = 0; // 429 responses seen
+		uint64_t totalWaitMs = 0;
+	};
+
+	inline std::string describe(const LimiterStats &s) {
+		return std::to_string(s.throttleEvents) + " throttle events, " + std::to_string(s.delayed) +
+		       " delayed requests (" + std::to_string(s.totalWaitMs) + " ms total), queue " +
+		       std::to_string(s.queued) + " now / " + std::to_string(s.peakQueued) + " peak";
+	}
+
+	// Token bucket per host. Callers reserve a slot up front and are told how
+	// long to wait for it, so both the blocking path (sleeps) and the async
+	// engine (delays the transfer) queue instead of failing. The refill rate is
+	// tuned AIMD-style: halved on every 429, nudged back up on success, and a
+	// Retry-After header pauses the whole host until it expires.
+	class RateLimiter {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static RateLimiter &instance() {
+			static RateLimiter limiter;
+			return limiter;
+		}
+
+		// Overrides the starting rate (requests/second) and burst for every host
+		// whose name contains `hostPart`.
+		void setLimit(const std::string &hostPart, double ratePerSecond, double burst) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			for (auto &rule: rules_) {
+				if (rule.hostPart == hostPart) {
+					rule.rate = ratePerSecond;
+					rule.burst = burst;
+					buckets_.clear();
+					return;
+				}
+			}
+			rules_.push_back({hostPart, ratePerSecond, burst});
+			buckets_.clear();
+		}
+
+		// Claims the next slot for `url` and returns how long the caller must
+		// wait before sending. Never blocks.
+		Clock::duration reserve(const std::string &url) {
+			if (isLoopback(url))
+				return Clock::duration::zero();
+			std::lock_guard<std::mutex> lock(mtx_);
+			Bucket &b = bucketFor(url);
+			auto now = Clock::now();
+			refill(b, now);
+
+			b.tokens -= 1.0;
+			Clock::time_point ready = now;
+			if (b.tokens < 0)
+				ready += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-b.tokens / b.rate));
+			if (b.blockedUntil > ready)
+				ready = b.blockedUntil;
+
+			auto wait = ready - now;
+			if (wait > Clock::duration::zero()) {
+				++delayed_;
+				totalWaitMs_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count());
+			}
+			return wait;
+		}
+
+		// Blocking variant: waits in line for a token, or until the caller's
+		// scope is cancelled. Waits past kLongWait (a Retry-After can pause a
+		// host for two minutes) get a pool stand-in so they don't take a
+		// worker out of the pool.
+		void acquire(const std::string &url) {
+			auto wait = reserve(url);
+			if (wait <= Clock::duration::zero())
+				return;
+			auto ready = Clock::now() + wait;
+			enterQueue();
+			{
+				std::optional<Threading::Blocking> standIn;
+				if (wait > kLongWait)
+					standIn.emplace();
+				for (auto now = Clock::now(); now < ready && !Threading::cancelled(); now = Clock::now())
+					std::this_thread::sleep_for(std::min<Clock::duration>(ready - now, std::chrono::milliseconds(100)));
+			}
+			leaveQueue();
+		}
+
+		// The async engine parks delayed transfers itself; it reports them here
+		// so queue depth covers both paths.
+		void enterQueue() {
+			size_t n = ++queued_;
+			size_t peak = peakQueued_;
+			while (n > peak && !peakQueued_.compare_exchange_weak(peak, n)) {
+			}
+		}
+
+		void leaveQueue() { --queued_; }
+
+		// Feeds a response back into the bucket. `retryAfter` is the raw header
+		// value, if any.
+		void onResponse(const std::string &url, int status, const std::string &retryAfter) {
+			if (isLoopback(url))
+				return;
+			std::lock_guard<std::mutex> lock(mtx_);
+			Bucket &b = bucketFor(url);
+			auto now = Clock::now();
+			if (status == 429) {
+				++throttleEvents_;
+				b.rate = std::max(kMinRate, b.rate * 0.5);
+				b.tokens = std::min(b.tokens, 0.0);
+				b.consecutive429 = std::min(b.consecutive429 + 1, 6);
+
+				auto pause = parseRetryAfter(retryAfter);
+				if (pause <= Clock::duration::zero())
+					pause = std::chrono::milliseconds(500) * (1 << b.consecutive429);
+				b.blockedUntil = std::max(b.blockedUntil, now + pause);
+			} else if (status > 0 && status < 500) {
+				b.consecutive429 = 0;
+				b.rate = std::min(b.maxRate, b.rate + kRecoveryStep);
+			}
+		}
+
+		LimiterStats stats() const {
+			LimiterStats s;
+			s.queued = queued_;
+			s.peakQueued = peakQueued_;
+			s.delayed = delayed_;
+			s.throttleEvents = throttleEvents_;
+			s.totalWaitMs = totalWaitMs_;
+			return s;
+		}
+
+		// Accepts delta-seconds; HTTP-date values fall back to exponential backoff.
+		static Clock::duration parseRetryAfter(const std::string &value) {
+			if (value.empty())
+				return Clock::duration::zero();
+			char *end = nullptr;
+			double secs = std::strtod(value.c_str(), &end);
+			if (end == value.c_str() || secs <= 0)
+				return Clock::duration::zero();
+			secs = std::min(secs, 120.0);
+			return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(secs));
+		}
+
+	private:
+		struct Rule {
+			std::string hostPart;
+			double rate;
+			double burst;
+		};
+
+		struct Bucket {
+			double rate = 0;
+			double maxRate = 0;
+			double burst = 0;
+			double tokens = 0;
+			int consecutive429 = 0;
+			Clock::time_point last;
+			Clock::time_point blockedUntil;
+		};
+
+		static constexpr double kMinRate = 0.5;
+		static constexpr auto kLongWait = std::chrono::milliseconds(250);
+		static constexpr double kRecoveryStep = 0.25;
+
+		RateLimiter() {
+			// Starting points tuned to what the Roblox endpoints tolerate from a
+			// single client before answering 429.
+			rules_ = {
+				{"presence.", 8, 16},
+				{"friends.", 6, 12},
+				{"thumbnails.", 20, 40},
+				{"games.", 8, 16},
+				{"auth.", 4, 8},
+				{"users.", 8, 16},
+			};
+		}
+
+		// The stub server and local proxies aren't remote services to be
+		// polite to, and throttling them would cap every benchmark.
+		static bool isLoopback(const std::string &url) {
+			std::string host = SessionPool::hostKey(url);
+			host.erase(0, host.find("://") + 3);
+			host.erase(host.rfind(':'));
+			return host == "127.0.0.1" || host == "localhost" || host == "[::1]";
+		}
+
+		Bucket &bucketFor(const std::string &url) {
+			std::string host = SessionPool::hostKey(url);
+			auto it = buckets_.find(host);
+			if (it != buckets_.end())
+				return it->second;
+
+			double rate = kDefaultRate, burst = kDefaultBurst;
+			for (const auto &rule: rules_) {
+				if (host.find(rule.hostPart) != std::string::npos) {
+					rate = rule.rate;
+					burst = rule.burst;
+					break;
+				}
+			}
+			Bucket b;
+			b.rate = b.maxRate = rate;
+			b.burst = b.tokens = burst;
+			b.last = Clock::now();
+			return buckets_.emplace(std::move(host), b).first->second;
+		}
+
+		static void refill(Bucket &b, Clock::time_point now) {
+			double elapsed = std::chrono::duration<double>(now - b.last).count();
+			b.last = now;
+			b.tokens = std::min(b.burst, b.tokens + elapsed * b.rate);
+		}
+
+		static constexpr double kDefaultRate = 20;
+		static constexpr double kDefaultBurst = 40;
+
+		mutable std::mutex mtx_;
+		std::vector<Rule> rules_;
+		std::unordered_map<std::string, Bucket> buckets_;
+
+		std::atomic<size_t> queued_{0};
+		std::atomic<size_t> peakQueued_{0};
+		std::atomic<uint64_t> delayed_{0};
+		std::atomic<uint64_t> throttleEvents_{0};
+		std::atomic<uint64_t> totalWaitMs_{0};
+	};
+}
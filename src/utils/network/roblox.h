@@ -3,6 +3,8 @@
 #include "roblox/common.h"
 #include "roblox/auth.h"
 #include "roblox/games.h"
+#include "roblox/profiles.h"
 #include "roblox/session.h"
 #include "roblox/social.h"
+#include "roblox/tickets.h"
 
@@ -2,46 +2,35 @@
 
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <mutex>
 #include <nlohmann/json.hpp>
 
 #include "http.hpp"
+#include "http_async.h"
+#include "ban_cache.h"
 #include "core/logging.hpp"
 #include "core/time_utils.h"
 #include "status.h"
+#include "csrf.h"
 
 
 namespace Roblox {
-	enum class BanCheckResult {
-		InvalidCookie,
-		Unbanned,
-		Banned,
-		Terminated
-	};
-
-	struct BanInfo {
-		BanCheckResult status = BanCheckResult::InvalidCookie;
-		time_t endDate = 0;
-	};
-
-	// Cache for ban check results so we don't hit the endpoint repeatedly.
-	inline std::mutex g_banStatusMutex;
-	inline std::unordered_map<std::string, BanCheckResult> g_banStatusCache;
-
-	static BanInfo checkBanStatus(const std::string &cookie) {
-		LOG_INFO("Checking moderation status");
-		HttpClient::Response response = HttpClient::get(
-			"https://usermoderation.roblox.com/v1/not-approved",
-			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
+	// The server turned the cookie itself away. Throttling and server errors
+	// say nothing about the account and must not be read as a dead session.
+	inline bool rejectsCookie(const HttpClient::Response &response) {
+		return response.status_code == 401 || response.status_code == 403;
+	}
 
-		if (response.status_code < 200 || response.status_code >= 300) {
-			LOG_ERROR("Failed moderation check: HTTP " + std::to_string(response.status_code));
+	inline BanInfo banInfoFromResponse(const HttpClient::Response &response) {
+		if (rejectsCookie(response))
 			return {BanCheckResult::InvalidCookie, 0};
-		}
+		if (response.status_code < 200 || response.status_code >= 300)
+			return {BanCheckResult::Unknown, 0};
 
 		auto j = HttpClient::decode(response);
 		if (j.is_object() && j.contains("punishmentTypeDescription")) {
+			// A shape we don't recognise says nothing reliable about the account.
+			if (!j["punishmentTypeDescription"].is_string())
+				return {BanCheckResult::Unknown, 0};
 			std::string punishmentType = j["punishmentTypeDescription"].get<std::string>();
 			time_t end = 0;
 			bool hasEndDate = j.contains("endDate") && j["endDate"].is_string() && !j["endDate"].get<std::string>().
@@ -57,37 +46,55 @@ namespace Roblox {
 
 			return {BanCheckResult::Banned, end};
 		}
-		if (j.empty())
-			return {BanCheckResult::Unbanned, 0};
 		return {BanCheckResult::Unbanned, 0};
 	}
 
-	static BanCheckResult cachedBanStatus(const std::string &cookie) { {
-			std::lock_guard<std::mutex> lock(g_banStatusMutex);
-			auto it = g_banStatusCache.find(cookie);
-			if (it != g_banStatusCache.end())
-				return it->second;
-		}
+	inline HttpClient::Request banCheckRequest(const std::string &cookie) {
+		return HttpClient::makeGet(
+			Routes::url(Routes::Service::UserModeration, "/v1/not-approved"),
+			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
+	}
 
-		BanCheckResult status = checkBanStatus(cookie).status; {
-			std::lock_guard<std::mutex> lock(g_banStatusMutex);
-			g_banStatusCache[cookie] = status;
-		}
-		return status;
+	// Only real verdicts are remembered. An Unknown result (transport failure,
+	// throttling, server error) would otherwise block the account for the
+	// whole negative TTL.
+	inline void rememberBanStatus(const std::string &cookie, const BanInfo &info) {
+		if (info.status != BanCheckResult::Unknown)
+			BanStatusCache::instance().store(cookie, info);
 	}
 
-	// Force refresh the cached ban status for a cookie
-	static BanCheckResult refreshBanStatus(const std::string &cookie) {
-		BanCheckResult status = checkBanStatus(cookie).status; {
-			std::lock_guard<std::mutex> lock(g_banStatusMutex);
-			g_banStatusCache[cookie] = status;
-		}
-		return status;
+	// Moderation states that rule out using the account at all.
+	inline bool blocksUse(BanCheckResult status) {
+		return status == BanCheckResult::Banned || status == BanCheckResult::Terminated ||
+		       status == BanCheckResult::InvalidCookie;
 	}
 
+	// cachedBanStatus for coroutines: a cache miss is checked through the
+	// async engine instead of blocking the calling worker. Reports nothing.
+	inline Async::Task<BanCheckResult> cachedBanStatusAsync(std::string cookie) {
+		if (auto hit = BanStatusCache::instance().lookup(cookie))
+			co_return hit->status;
+		HttpClient::Response response = co_await HttpClient::fetch(banCheckRequest(cookie));
+		BanInfo info = banInfoFromResponse(response);
+		rememberBanStatus(cookie, info);
+		co_return info.status;
+	}
+
+	static BanInfo checkBanStatus(const std::string &cookie) {
+		LOG_INFO("Checking moderation status");
+		HttpClient::Response response = HttpClient::perform(banCheckRequest(cookie));
+		if (response.status_code < 200 || response.status_code >= 300)
+			LOG_ERROR("Failed moderation check: HTTP " + std::to_string(response.status_code));
+
+		BanInfo info = banInfoFromResponse(response);
+		rememberBanStatus(cookie, info);
+		return info;
+	}
 
-	static bool isCookieValid(const std::string &cookie) {
-		return cachedBanStatus(cookie) != BanCheckResult::InvalidCookie;
+	static BanCheckResult cachedBanStatus(const std::string &cookie) {
+		if (auto hit = BanStatusCache::instance().lookup(cookie))
+			return hit->status;
+		return checkBanStatus(cookie).status;
 	}
 
 	static bool canUseCookie(const std::string &cookie) {
@@ -113,7 +120,7 @@ namespace Roblox {
 
 		LOG_INFO("Fetching profile info");
 		HttpClient::Response response = HttpClient::get(
-			"https://users.roblox.com/v1/users/authenticated",
+			Routes::url(Routes::Service::Users, "/v1/users/authenticated"),
 			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
 
 		if (response.status_code < 200 || response.status_code >= 300) {
@@ -128,29 +135,8 @@ namespace Roblox {
 	static std::string fetchAuthTicket(const std::string &cookie) {
 		if (!canUseCookie(cookie))
 			return "";
-		LOG_INFO("Fetching x-csrf token");
-		std::cout << cookie;
-		auto csrfResponse = HttpClient::post(
-			"https://auth.roblox.com/v1/authentication-ticket",
-			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
-
-		auto csrfToken = csrfResponse.headers.find("x-csrf-token");
-		if (csrfToken == csrfResponse.headers.end()) {
-			std::cerr << "failed to get CSRF token\n";
-
-			LOG_INFO("Failed to get CSRF token");
-			return "";
-		}
-
 		LOG_INFO("Fetching authentication ticket");
-		auto ticketResponse = HttpClient::post(
-			"https://auth.roblox.com/v1/authentication-ticket",
-			{
-				{"Cookie", ".ROBLOSECURITY=" + cookie},
-				{"Origin", "https://www.roblox.com"},
-				{"Referer", "https://www.roblox.com/"},
-				{"X-CSRF-TOKEN", csrfToken->second}
-			});
+		auto ticketResponse = csrfPost(Routes::url(Routes::Service::Auth, "/v1/authentication-ticket"), cookie);
 
 		if (ticketResponse.status_code < 200 || ticketResponse.status_code >= 300) {
 			LOG_ERROR("Failed to fetch auth ticket: HTTP " + std::to_string(ticketResponse.status_code));
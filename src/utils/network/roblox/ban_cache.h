@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "core/hash.h"
+
+namespace Roblox {
+	enum class BanCheckResult {
+		InvalidCookie,
+		Unbanned,
+		Banned,
+		Terminated,
+		Unknown // no usable answer (transport failure, 429, 5xx); never cached
+	};
+
+	struct BanInfo {
+		BanCheckResult status = BanCheckResult::InvalidCookie;
+		time_t endDate = 0;
+	};
+
+	// Moderation results per account, keyed by a digest of the cookie. Clean
+	// results live longer than bans and invalid cookies: a usable account is
+	// re-verified every few minutes so new bans still show up quickly, while a
+	// negative result is retried sooner in case it was a temporary failure or
+	// the ban has been lifted.
+	class BanStatusCache {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static BanStatusCache &instance() {
+			static BanStatusCache cache;
+			return cache;
+		}
+
+		void setTtl(std::chrono::seconds positive, std::chrono::seconds negative) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			positiveTtl_ = positive;
+			negativeTtl_ = negative;
+		}
+
+		std::chrono::seconds positiveTtl() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return positiveTtl_;
+		}
+
+		std::chrono::seconds negativeTtl() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return negativeTtl_;
+		}
+
+		std::optional<BanInfo> lookup(const std::string &cookie) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = entries_.find(fnv1a64(cookie));
+			if (it == entries_.end())
+				return std::nullopt;
+			if (Clock::now() >= it->second.expires) {
+				entries_.erase(it);
+				return std::nullopt;
+			}
+			return it->second.info;
+		}
+
+		void store(const std::string &cookie, const BanInfo &info) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto ttl = info.status == BanCheckResult::Unbanned ? positiveTtl_ : negativeTtl_;
+			entries_[fnv1a64(cookie)] = Entry{info, Clock::now() + ttl};
+		}
+
+		void invalidate(const std::string &cookie) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			entries_.erase(fnv1a64(cookie));
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(mtx_);
+			entries_.clear();
+		}
+
+	private:
+		struct Entry {
+			BanInfo info;
+			Clock::time_point expires;
+		};
+
+		mutable std::mutex mtx_;
+		std::chrono::seconds positiveTtl_{300};
+		std::chrono::seconds negativeTtl_{60};
+		std::unordered_map<uint64_t, Entry> entries_;
+	};
+}
@@ -1,30 +1,99 @@
 #pragma once
 
 #include <imgui.h>
+#include <cstdint>
 #include <random>
 #include <string>
+#include <string_view>
 
 
-static ImVec4 getStatusColor(std::string statusCode) {
-	if (statusCode == "Online") {
-		return ImVec4(0.6f, 0.8f, 0.95f, 1.0f);
-	}
-	if (statusCode == "InGame") {
-		return ImVec4(0.6f, 0.9f, 0.7f, 1.0f);
-	}
-	if (statusCode == "InStudio") {
-		return ImVec4(1.0f, 0.85f, 0.7f, 1.0f);
+// Account and voice states as one byte each. The strings are what the
+// APIs and accounts.json use; everything else compares the enums.
+enum class AccountStatus : uint8_t {
+	Unknown,
+	Offline,
+	Online,
+	InGame,
+	InStudio,
+	Invisible,
+	Banned,
+	Terminated,
+};
+
+enum class VoiceStatus : uint8_t {
+	Unknown,
+	Enabled,
+	Disabled,
+	Banned,
+};
+
+inline const char *toString(AccountStatus status) {
+	switch (status) {
+		case AccountStatus::Offline: return "Offline";
+		case AccountStatus::Online: return "Online";
+		case AccountStatus::InGame: return "InGame";
+		case AccountStatus::InStudio: return "InStudio";
+		case AccountStatus::Invisible: return "Invisible";
+		case AccountStatus::Banned: return "Banned";
+		case AccountStatus::Terminated: return "Terminated";
+		default: return "";
 	}
-	if (statusCode == "Invisible") {
-		return ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+}
+
+inline AccountStatus accountStatusFromString(std::string_view s) {
+	for (auto status: {AccountStatus::Offline, AccountStatus::Online, AccountStatus::InGame,
+	                   AccountStatus::InStudio, AccountStatus::Invisible, AccountStatus::Banned,
+	                   AccountStatus::Terminated}) {
+		if (s == toString(status))
+			return status;
 	}
-	if (statusCode == "Banned") {
-		return ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+	return AccountStatus::Unknown;
+}
+
+// Banned and terminated accounts can't launch, join or be queried.
+inline bool isRestricted(AccountStatus status) {
+	return status == AccountStatus::Banned || status == AccountStatus::Terminated;
+}
+
+inline const char *toString(VoiceStatus status) {
+	switch (status) {
+		case VoiceStatus::Enabled: return "Enabled";
+		case VoiceStatus::Disabled: return "Disabled";
+		case VoiceStatus::Banned: return "Banned";
+		default: return "Unknown";
 	}
-	if (statusCode == "Terminated") {
-		return ImVec4(0.8f, 0.1f, 0.1f, 1.0f);  // Darker red for terminated accounts
+}
+
+inline VoiceStatus voiceStatusFromString(std::string_view s) {
+	if (s == "Enabled")
+		return VoiceStatus::Enabled;
+	if (s == "Disabled")
+		return VoiceStatus::Disabled;
+	if (s == "Banned")
+		return VoiceStatus::Banned;
+	return VoiceStatus::Unknown;
+}
+
+static ImVec4 getStatusColor(AccountStatus status) {
+	switch (status) {
+		case AccountStatus::Online:
+			return ImVec4(0.6f, 0.8f, 0.95f, 1.0f);
+		case AccountStatus::InGame:
+			return ImVec4(0.6f, 0.9f, 0.7f, 1.0f);
+		case AccountStatus::InStudio:
+			return ImVec4(1.0f, 0.85f, 0.7f, 1.0f);
+		case AccountStatus::Banned:
+			return ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+		case AccountStatus::Terminated:
+			return ImVec4(0.8f, 0.1f, 0.1f, 1.0f);  // Darker red for terminated accounts
+		default:
+			return ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
 	}
-	return ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+}
+
+// Friend presence is still kept as the API string.
+static ImVec4 getStatusColor(const std::string &statusCode) {
+	return getStatusColor(accountStatusFromString(statusCode));
 }
 
 static std::string generateSessionId() {
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "http.hpp"
+#include "http_async.h"
+#include "system/task.h"
+#include "core/hash.h"
+
+// Roblox rejects mutating requests without a valid X-CSRF-TOKEN and hands out
+// a fresh one in the 403 it answers with. Tokens stay valid across requests,
+// so we remember the last one per cookie and only pay the extra round trip
+// when the server says it has gone stale.
+namespace Roblox {
+	class CsrfTokens {
+	public:
+		static CsrfTokens &instance() {
+			static CsrfTokens tokens;
+			return tokens;
+		}
+
+		std::string get(const std::string &cookie) const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = tokens_.find(fnv1a64(cookie));
+			return it == tokens_.end() ? std::string() : it->second;
+		}
+
+		void put(const std::string &cookie, const std::string &token) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			tokens_[fnv1a64(cookie)] = token;
+		}
+
+		void invalidate(const std::string &cookie) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			tokens_.erase(fnv1a64(cookie));
+		}
+
+	private:
+		mutable std::mutex mtx_;
+		// Keyed by cookie digest so the cookie itself isn't kept around twice.
+		std::unordered_map<uint64_t, std::string> tokens_;
+	};
+
+	inline HttpClient::Request csrfRequest(const std::string &url, const std::string &cookie,
+	                                       const std::string &jsonBody, const std::string &token) {
+		HttpClient::Request req = HttpClient::makePost(url, {}, jsonBody);
+		req.headers["Cookie"] = ".ROBLOSECURITY=" + cookie;
+		req.headers["Origin"] = "https://www.roblox.com";
+		req.headers["Referer"] = "https://www.roblox.com/";
+		if (!token.empty())
+			req.headers["X-CSRF-TOKEN"] = token;
+		return req;
+	}
+
+	// The token to retry with after `resp`, or empty if there is no point.
+	inline std::string refreshedCsrfToken(const std::string &cookie, const std::string &sent,
+	                                      const HttpClient::Response &resp) {
+		if (resp.status_code != 403)
+			return "";
+		std::string fresh = HttpClient::headerValue(resp, "x-csrf-token");
+		if (fresh.empty() || fresh == sent)
+			return "";
+		CsrfTokens::instance().put(cookie, fresh);
+		return fresh;
+	}
+
+	// POST with the cached token for this cookie. A 403 carrying a different
+	// token means ours was missing or stale: store the new one and retry once.
+	inline HttpClient::Response csrfPost(const std::string &url, const std::string &cookie,
+	                                     const std::string &jsonBody = std::string()) {
+		std::string token = CsrfTokens::instance().get(cookie);
+		HttpClient::Response resp = HttpClient::perform(csrfRequest(url, cookie, jsonBody, token));
+		std::string fresh = refreshedCsrfToken(cookie, token, resp);
+		if (fresh.empty())
+			return resp;
+		return HttpClient::perform(csrfRequest(url, cookie, jsonBody, fresh));
+	}
+
+	// csrfPost for coroutines, suspending on each request instead of blocking.
+	inline Async::Task<HttpClient::Response> csrfPostAsync(std::string url, std::string cookie,
+	                                                       std::string jsonBody = std::string()) {
+		std::string token = CsrfTokens::instance().get(cookie);
+		HttpClient::Response resp = co_await HttpClient::fetch(csrfRequest(url, cookie, jsonBody, token));
+		std::string fresh = refreshedCsrfToken(cookie, token, resp);
+		if (fresh.empty())
+			co_return resp;
+		co_return co_await HttpClient::fetch(csrfRequest(url, cookie, jsonBody, fresh));
+	}
+}
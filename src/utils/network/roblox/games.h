@@ -28,9 +28,11 @@ namespace Roblox {
 	inline GameDetail getGameDetail(uint64_t universeId) {
 		using nlohmann::json;
 		const std::string url =
-				"https://games.roblox.com/v1/games?universeIds=" + std::to_string(universeId);
+				Routes::url(Routes::Service::Games, "/v1/games?universeIds=") + std::to_string(universeId);
 
-                HttpClient::Response resp = HttpClient::get(url);
+                auto req = HttpClient::makeGet(url);
+                req.cacheTtlSeconds = 600;
+                HttpClient::Response resp = HttpClient::perform(req);
                 if (resp.status_code < 200 || resp.status_code >= 300) {
                         LOG_ERROR("Game detail fetch failed: HTTP " + std::to_string(resp.status_code));
                         return GameDetail{};
@@ -71,7 +73,7 @@ namespace Roblox {
 	static ServerPage getPublicServersPage(uint64_t placeId,
 	                                       const std::string &cursor = {}) {
 		std::string url =
-				"https://games.roblox.com/v1/games/" + std::to_string(placeId) +
+				Routes::url(Routes::Service::Games, "/v1/games/") + std::to_string(placeId) +
 				"/servers/Public?sortOrder=Asc&limit=100" +
 				(cursor.empty() ? "" : "&cursor=" + cursor);
 
@@ -113,7 +115,7 @@ namespace Roblox {
 	static std::vector<GameInfo> searchGames(const std::string &query) {
 		const std::string sessionId = generateSessionId();
 		auto resp = HttpClient::get(
-			"https://apis.roblox.com/search-api/omni-search",
+			Routes::url(Routes::Service::Apis, "/search-api/omni-search"),
 			{{"Accept", "application/json"}},
 			cpr::Parameters{
 				{"searchQuery", query},
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "http.hpp"
+#include "http_async.h"
+#include "core/logging.hpp"
+
+// Account profiles (user ID, username, display name) resolved in bulk.
+// Each cookie is authenticated once to learn whose it is; names for known
+// user IDs come from the multi-user lookup, 100 IDs per request, and are
+// cached per user ID so repeated refreshes don't ask again.
+namespace Roblox {
+	struct UserProfile {
+		uint64_t userId = 0;
+		std::string username;
+		std::string displayName;
+	};
+
+	// users.roblox.com/v1/users accepts at most this many IDs per call.
+	inline constexpr size_t kProfileBatchSize = 100;
+
+	class ProfileCache {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static ProfileCache &instance() {
+			static ProfileCache cache;
+			return cache;
+		}
+
+		std::optional<UserProfile> lookup(uint64_t userId) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = entries_.find(userId);
+			if (it == entries_.end() || Clock::now() >= it->second.expires)
+				return std::nullopt;
+			return it->second.profile;
+		}
+
+		void store(const UserProfile &profile) {
+			if (profile.userId == 0)
+				return;
+			std::lock_guard<std::mutex> lock(mtx_);
+			entries_[profile.userId] = Entry{profile, Clock::now() + kTtl};
+		}
+
+	private:
+		static constexpr std::chrono::minutes kTtl{10};
+
+		struct Entry {
+			UserProfile profile;
+			Clock::time_point expires;
+		};
+
+		std::mutex mtx_;
+		std::unordered_map<uint64_t, Entry> entries_;
+	};
+
+	inline UserProfile profileFromJson(const nlohmann::json &j) {
+		UserProfile p;
+		if (!j.is_object())
+			return p;
+		p.userId = j.value("id", 0ULL);
+		p.username = j.value("name", "");
+		p.displayName = j.value("displayName", "");
+		return p;
+	}
+
+	// Who each cookie belongs to, one users/authenticated call per cookie
+	// with at most maxInFlight outstanding. Results line up with cookies;
+	// cookies that fail come back with userId 0.
+	static std::vector<UserProfile> authenticateProfiles(const std::vector<std::string> &cookies,
+	                                                     size_t maxInFlight = 8) {
+		std::vector<UserProfile> results(cookies.size());
+		std::deque<std::pair<size_t, std::future<HttpClient::Response> > > window;
+		int failures = 0;
+
+		auto drainOne = [&] {
+			auto [index, future] = std::move(window.front());
+			window.pop_front();
+			HttpClient::Response response = future.get();
+			if (response.status_code < 200 || response.status_code >= 300) {
+				++failures;
+				return;
+			}
+			results[index] = profileFromJson(HttpClient::decode(response));
+			ProfileCache::instance().store(results[index]);
+		};
+
+		for (size_t i = 0; i < cookies.size(); ++i) {
+			if (cookies[i].empty())
+				continue;
+			if (window.size() >= std::max<size_t>(1, maxInFlight))
+				drainOne();
+			window.emplace_back(i, HttpClient::AsyncEngine::instance().get(
+				                    Routes::url(Routes::Service::Users, "/v1/users/authenticated"),
+				                    {{"Cookie", ".ROBLOSECURITY=" + cookies[i]}}));
+		}
+		while (!window.empty())
+			drainOne();
+
+		LOG_INFO("Authenticated " + std::to_string(cookies.size()) + " accounts (" + std::to_string(failures) +
+			" failed)");
+		return results;
+	}
+
+	// Current names for the given user IDs. Fresh cache entries are reused;
+	// the rest go out as concurrent batches of kProfileBatchSize. IDs the
+	// API does not know are missing from the result.
+	static std::unordered_map<uint64_t, UserProfile> resolveProfiles(const std::vector<uint64_t> &userIds) {
+		std::unordered_map<uint64_t, UserProfile> out;
+		std::vector<uint64_t> missing;
+		for (uint64_t id: userIds) {
+			if (id == 0 || out.count(id))
+				continue;
+			if (auto hit = ProfileCache::instance().lookup(id))
+				out[id] = *hit;
+			else if (std::find(missing.begin(), missing.end(), id) == missing.end())
+				missing.push_back(id);
+		}
+
+		std::vector<std::future<HttpClient::Response> > batches;
+		for (size_t i = 0; i < missing.size(); i += kProfileBatchSize) {
+			std::vector<uint64_t> batch(missing.begin() + i,
+			                            missing.begin() + std::min(missing.size(), i + kProfileBatchSize));
+			nlohmann::json payload = {{"userIds", batch}, {"excludeBannedUsers", false}};
+			batches.push_back(HttpClient::AsyncEngine::instance().post(
+				Routes::url(Routes::Service::Users, "/v1/users"), {}, payload.dump()));
+		}
+
+		for (auto &f: batches) {
+			HttpClient::Response response = f.get();
+			if (response.status_code < 200 || response.status_code >= 300) {
+				LOG_INFO("Profile batch failed: HTTP " + std::to_string(response.status_code));
+				continue;
+			}
+			auto j = HttpClient::decode(response);
+			if (!j.contains("data") || !j["data"].is_array())
+				continue;
+			for (const auto &item: j["data"]) {
+				UserProfile p = profileFromJson(item);
+				if (p.userId == 0)
+					continue;
+				ProfileCache::instance().store(p);
+				out[p.userId] = std::move(p);
+			}
+		}
+
+		if (!missing.empty())
+			LOG_INFO("Resolved " + std::to_string(missing.size()) + " profiles in " + std::to_string(batches.size()) +
+				" batches");
+		return out;
+	}
+}
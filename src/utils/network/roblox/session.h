@@ -8,6 +8,7 @@
 #include "http.hpp"
 #include "core/logging.hpp"
 #include "auth.h"
+#include "common.h"
 #include "status.h"
 
 
@@ -21,7 +22,7 @@ namespace Roblox {
                 LOG_INFO("Fetching user presence");
                 nlohmann::json payload = {{"userIds", {userId}}};
                 HttpClient::Response response = HttpClient::post(
-                        "https://presence.roproxy.com/v1/presence/users",
+                        Routes::url(Routes::Service::Presence, "/v1/presence/users"),
                         {{"Cookie", ".ROBLOSECURITY=" + cookie}},
                         payload.dump());
                 if (response.status_code < 200 || response.status_code >= 300) {
@@ -52,26 +53,24 @@ namespace Roblox {
 	}
 
 	struct VoiceSettings {
-		std::string status;
+		VoiceStatus status = VoiceStatus::Unknown;
 		time_t bannedUntil = 0;
 	};
 
-        static VoiceSettings getVoiceChatStatus(const std::string &cookie) {
-                if (!canUseCookie(cookie))
-                        return {"Banned", 0};
-
-                LOG_INFO("Fetching voice chat settings");
-                auto resp = HttpClient::get(
-                        "https://voice.roblox.com/v1/settings",
-                        {{"Cookie", ".ROBLOSECURITY=" + cookie}}
-                );
+	inline HttpClient::Request voiceSettingsRequest(const std::string &cookie) {
+		return HttpClient::makeGet(
+			Routes::url(Routes::Service::Voice, "/v1/settings"),
+			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
+	}
 
-                if (resp.status_code < 200 || resp.status_code >= 300) {
-                        LOG_INFO("Failed to fetch voice settings: HTTP " +
-                                std::to_string(resp.status_code));
+	// Parses a voice settings response; a 403 means voice chat is banned.
+	inline VoiceSettings voiceSettingsFromResponse(const HttpClient::Response &resp) {
+		if (resp.status_code < 200 || resp.status_code >= 300) {
+			LOG_INFO("Failed to fetch voice settings: HTTP " +
+				std::to_string(resp.status_code));
 			if (resp.status_code == 403)
-				return {"Banned", 0};
-			return {"Unknown", 0};
+				return {VoiceStatus::Banned, 0};
+			return {VoiceStatus::Unknown, 0};
 		}
 
 		auto j = HttpClient::decode(resp);
@@ -86,13 +85,21 @@ namespace Roblox {
 		}
 
 		if (banned)
-			return {"Banned", bannedUntil};
+			return {VoiceStatus::Banned, bannedUntil};
 		if (enabled || opted)
-			return {"Enabled", 0};
+			return {VoiceStatus::Enabled, 0};
 		if (eligible)
-			return {"Disabled", 0};
+			return {VoiceStatus::Disabled, 0};
 
-		return {"Disabled", 0};
+		return {VoiceStatus::Disabled, 0};
+	}
+
+        static VoiceSettings getVoiceChatStatus(const std::string &cookie) {
+                if (!canUseCookie(cookie))
+                        return {VoiceStatus::Banned, 0};
+
+                LOG_INFO("Fetching voice chat settings");
+		return voiceSettingsFromResponse(HttpClient::perform(voiceSettingsRequest(cookie)));
 	}
 
 	struct PresenceData {
@@ -102,24 +109,8 @@ namespace Roblox {
 		std::string gameId;
 	};
 
-	static std::unordered_map<uint64_t, PresenceData>
-        getPresences(const std::vector<uint64_t> &userIds,
-                     const std::string &cookie) {
-                if (!canUseCookie(cookie))
-                        return {};
-
-                nlohmann::json payload = {{"userIds", userIds}};
-
-		auto resp = HttpClient::post(
-			"https://presence.roblox.com/v1/presence/users",
-			{{"Cookie", ".ROBLOSECURITY=" + cookie}},
-			payload.dump());
-
-                if (resp.status_code < 200 || resp.status_code >= 300) {
-                        LOG_ERROR("Batch presence failed: HTTP " + std::to_string(resp.status_code));
-                        return {};
-                }
-
+	// Parses a presence/users response into userId -> presence.
+	inline std::unordered_map<uint64_t, PresenceData> presencesFromResponse(const HttpClient::Response &resp) {
 		nlohmann::json j = HttpClient::decode(resp);
 		std::unordered_map<uint64_t, PresenceData> out;
 
@@ -138,4 +129,27 @@ namespace Roblox {
 		}
 		return out;
 	}
+
+	static std::unordered_map<uint64_t, PresenceData>
+        getPresences(const std::vector<uint64_t> &userIds,
+                     const std::string &cookie) {
+                if (!canUseCookie(cookie))
+                        return {};
+
+                nlohmann::json payload = {{"userIds", userIds}};
+
+		auto resp = HttpClient::post(
+			Routes::url(Routes::Service::Presence, "/v1/presence/users"),
+			{{"Cookie", ".ROBLOSECURITY=" + cookie}},
+			payload.dump());
+
+                if (resp.cancelled)
+                        return {};
+                if (resp.status_code < 200 || resp.status_code >= 300) {
+                        LOG_ERROR("Batch presence failed: HTTP " + std::to_string(resp.status_code));
+                        return {};
+                }
+
+		return presencesFromResponse(resp);
+	}
 }
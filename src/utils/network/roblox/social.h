@@ -1,15 +1,15 @@
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <nlohmann/json.hpp>
 
 #include "http.hpp"
+#include "http_async.h"
 #include "core/logging.hpp"
 #include "auth.h"
+#include "csrf.h"
 #include "threading.h"
 
 #include "../../components/components.h"
@@ -24,9 +24,11 @@ namespace Roblox
 		LOG_INFO("Fetching friends list");
 
 		HttpClient::Response resp = HttpClient::get(
-			"https://friends.roblox.com/v1/users/" + userId + "/friends",
+			Routes::url(Routes::Service::Friends, "/v1/users/") + userId + "/friends",
 			{{"Cookie", ".ROBLOSECURITY=" + cookie}});
 
+		if (resp.cancelled)
+			return {}; // the friends tab moved on to another account
 		if (resp.status_code < 200 || resp.status_code >= 300)
 		{
 			LOG_ERROR("Failed to fetch friends: HTTP " + std::to_string(resp.status_code));
@@ -52,9 +54,11 @@ namespace Roblox
 	static FriendInfo getUserInfo(const std::string &userId)
 	{
 		LOG_INFO("Fetching user info");
-		HttpClient::Response resp = HttpClient::get(
-			"https://users.roblox.com/v1/users/" + userId,
+		auto req = HttpClient::makeGet(
+			Routes::url(Routes::Service::Users, "/v1/users/") + userId,
 			{{"Accept", "application/json"}});
+		req.cacheTtlSeconds = 300;
+		HttpClient::Response resp = HttpClient::perform(req);
 
 		if (resp.status_code < 200 || resp.status_code >= 300)
 		{
@@ -92,67 +96,39 @@ namespace Roblox
 		if (!canUseCookie(cookie))
 			return FriendDetail{};
 
+		auto &engine = HttpClient::AsyncEngine::instance();
+		auto userFut = engine.get(Routes::url(Routes::Service::Users, "/v1/users/") + userId, {{"Accept", "application/json"}});
+		auto followersFut = engine.get(Routes::url(Routes::Service::Friends, "/v1/users/") + userId + "/followers/count");
+		auto followingFut = engine.get(Routes::url(Routes::Service::Friends, "/v1/users/") + userId + "/followings/count");
+
 		FriendDetail d;
-		mutex m;
-		condition_variable cv;
-		int remaining = 3;
+		auto resp = userFut.get();
+		if (resp.status_code >= 200 && resp.status_code < 300) {
+			nlohmann::json j = HttpClient::decode(resp);
+			d.id = j.value("id", 0ULL);
+			d.username = j.value("name", "");
+			d.displayName = j.value("displayName", "");
+			d.description = j.value("description", "");
+			d.createdIso = j.value("created", "");
+		}
 
-		auto signalDone = [&]
-		{
-			lock_guard<mutex> lk(m);
-			if (--remaining == 0)
-				cv.notify_one();
-		};
-
-		Threading::newThread([&, userId]
-							 {
-			auto resp = HttpClient::get(
-				"https://users.roblox.com/v1/users/" + userId,
-				{{"Accept", "application/json"}}
-			);
-                        if (resp.status_code >= 200 && resp.status_code < 300) {
-				nlohmann::json j = HttpClient::decode(resp);
-				d.id = j.value("id", 0ULL);
-				d.username = j.value("name", "");
-				d.displayName = j.value("displayName", "");
-				d.description = j.value("description", "");
-				d.createdIso = j.value("created", "");
-			}
-			signalDone(); });
-
-		Threading::newThread([&, userId]
-							 {
-			auto resp = HttpClient::get(
-				"https://friends.roblox.com/v1/users/" + userId + "/followers/count",
-				{}
-			);
-                        if (resp.status_code >= 200 && resp.status_code < 300) {
-				try {
-					d.followers = nlohmann::json::parse(resp.text).value("count", 0);
-				} catch (const std::exception &e) {
-					LOG_ERROR(std::string("Failed to parse followers count: ") + e.what());
-				}
-			}
-			signalDone(); });
-
-		Threading::newThread([&, userId]
-							 {
-			auto resp = HttpClient::get(
-				"https://friends.roblox.com/v1/users/" + userId + "/followings/count",
-				{}
-			);
-                        if (resp.status_code >= 200 && resp.status_code < 300) {
-				try {
-					d.following = nlohmann::json::parse(resp.text).value("count", 0);
-				} catch (const std::exception &e) {
-					LOG_ERROR(std::string("Failed to parse following count: ") + e.what());
-				}
+		resp = followersFut.get();
+		if (resp.status_code >= 200 && resp.status_code < 300) {
+			try {
+				d.followers = nlohmann::json::parse(resp.text).value("count", 0);
+			} catch (const std::exception &e) {
+				LOG_ERROR(std::string("Failed to parse followers count: ") + e.what());
 			}
-			signalDone(); });
+		}
 
-		unique_lock<mutex> lk(m);
-		cv.wait(lk, [&]
-				{ return remaining == 0; });
+		resp = followingFut.get();
+		if (resp.status_code >= 200 && resp.status_code < 300) {
+			try {
+				d.following = nlohmann::json::parse(resp.text).value("count", 0);
+			} catch (const std::exception &e) {
+				LOG_ERROR(std::string("Failed to parse following count: ") + e.what());
+			}
+		}
 
 		return d;
 	}
@@ -164,7 +140,7 @@ namespace Roblox
 			{"excludeBannedUsers", true}};
 
 		auto resp = HttpClient::post(
-			"https://users.roblox.com/v1/usernames/users",
+			Routes::url(Routes::Service::Users, "/v1/usernames/users"),
 			{},
 			payload.dump());
 
@@ -194,29 +170,13 @@ namespace Roblox
 				*outResponse = "Banned cookie";
 			return false;
 		}
-		std::string url = "https://friends.roblox.com/v1/users/" + targetUserId +
+		std::string url = Routes::url(Routes::Service::Friends, "/v1/users/") + targetUserId +
 						  "/request-friendship";
 
-		auto csrfResp = HttpClient::post(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
-		auto it = csrfResp.headers.find("x-csrf-token");
-		if (it == csrfResp.headers.end())
-		{
-			if (outResponse)
-				*outResponse = "Missing CSRF token";
-			std::cerr << "friend request: missing CSRF token\n";
-			return false;
-		}
-
 		nlohmann::json body = {
 			{"friendshipOriginSourceType", 0}};
 
-		auto resp = HttpClient::post(
-			url,
-			{{"Cookie", ".ROBLOSECURITY=" + cookie},
-			 {"Origin", "https://www.roblox.com"},
-			 {"Referer", "https://www.roblox.com/"},
-			 {"X-CSRF-TOKEN", it->second}},
-			body.dump());
+		auto resp = csrfPost(url, cookie, body.dump());
 
 		if (outResponse)
 			*outResponse = resp.text;
@@ -250,24 +210,10 @@ namespace Roblox
 				*outResponse = "Banned cookie";
 			return false;
 		}
-		std::string url = "https://friends.roblox.com/v1/users/" + targetUserId +
+		std::string url = Routes::url(Routes::Service::Friends, "/v1/users/") + targetUserId +
 						  "/unfriend";
 
-		auto csrfResp = HttpClient::post(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
-		auto it = csrfResp.headers.find("x-csrf-token");
-		if (it == csrfResp.headers.end())
-		{
-			if (outResponse)
-				*outResponse = "Missing CSRF token";
-			return false;
-		}
-
-		auto resp = HttpClient::post(
-			url,
-			{{"Cookie", ".ROBLOSECURITY=" + cookie},
-			 {"Origin", "https://www.roblox.com"},
-			 {"Referer", "https://www.roblox.com/"},
-			 {"X-CSRF-TOKEN", it->second}});
+		auto resp = csrfPost(url, cookie);
 
 		if (outResponse)
 			*outResponse = resp.text;
@@ -290,23 +236,9 @@ namespace Roblox
 				*outResponse = "Banned cookie";
 			return false;
 		}
-		std::string url = "https://friends.roblox.com/v1/users/" + targetUserId + "/follow";
+		std::string url = Routes::url(Routes::Service::Friends, "/v1/users/") + targetUserId + "/follow";
 
-		auto csrfResp = HttpClient::post(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
-		auto it = csrfResp.headers.find("x-csrf-token");
-		if (it == csrfResp.headers.end())
-		{
-			if (outResponse)
-				*outResponse = "Missing CSRF token";
-			return false;
-		}
-
-		auto resp = HttpClient::post(
-			url,
-			{{"Cookie", ".ROBLOSECURITY=" + cookie},
-			 {"Origin", "https://www.roblox.com"},
-			 {"Referer", "https://www.roblox.com/"},
-			 {"X-CSRF-TOKEN", it->second}});
+		auto resp = csrfPost(url, cookie);
 
 		if (outResponse)
 			*outResponse = resp.text;
@@ -322,23 +254,9 @@ namespace Roblox
 				*outResponse = "Banned cookie";
 			return false;
 		}
-		std::string url = "https://friends.roblox.com/v1/users/" + targetUserId + "/unfollow";
+		std::string url = Routes::url(Routes::Service::Friends, "/v1/users/") + targetUserId + "/unfollow";
 
-		auto csrfResp = HttpClient::post(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
-		auto it = csrfResp.headers.find("x-csrf-token");
-		if (it == csrfResp.headers.end())
-		{
-			if (outResponse)
-				*outResponse = "Missing CSRF token";
-			return false;
-		}
-
-		auto resp = HttpClient::post(
-			url,
-			{{"Cookie", ".ROBLOSECURITY=" + cookie},
-			 {"Origin", "https://www.roblox.com"},
-			 {"Referer", "https://www.roblox.com/"},
-			 {"X-CSRF-TOKEN", it->second}});
+		auto resp = csrfPost(url, cookie);
 
 		if (outResponse)
 			*outResponse = resp.text;
@@ -354,29 +272,9 @@ namespace Roblox
 				*outResponse = "Banned cookie";
 			return false;
 		}
-		std::string url = "https://www.roblox.com/users/" + targetUserId + "/block";
+		std::string url = Routes::url(Routes::Service::Www, "/users/" + targetUserId + "/block");
 
-		auto csrfResp = HttpClient::post(url, {{"Cookie", ".ROBLOSECURITY=" + cookie}});
-		if (csrfResp.status_code < 200 || csrfResp.status_code >= 300)
-		{
-			if (outResponse)
-				*outResponse = "Failed CSRF";
-			return false;
-		}
-		auto it = csrfResp.headers.find("x-csrf-token");
-		if (it == csrfResp.headers.end())
-		{
-			if (outResponse)
-				*outResponse = "Missing CSRF token";
-			return false;
-		}
-
-		auto resp = HttpClient::post(
-			url,
-			{{"Cookie", ".ROBLOSECURITY=" + cookie},
-			 {"Origin", "https://www.roblox.com"},
-			 {"Referer", "https://www.roblox.com/"},
-			 {"X-CSRF-TOKEN", it->second}});
+		auto resp = csrfPost(url, cookie);
 
 		if (outResponse)
 			*outResponse = resp.text;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "http.hpp"
+#include "auth.h"
+#include "csrf.h"
+#include "system/task.h"
+#include "core/hash.h"
+
+// Authentication tickets minted ahead of a launch. Hovering Join or
+// starting a multi-account launch kicks off one mint per account in
+// parallel; the launch loop then just picks the ticket up instead of paying
+// CSRF + ticket round trips right before every ShellExecute.
+namespace Roblox {
+	// One ticket POST, no user-facing errors; callers decide how to report
+	// an empty result. Banned, terminated and invalid accounts get none.
+	inline Async::Task<std::string> mintAuthTicket(std::string cookie) {
+		BanCheckResult status = co_await cachedBanStatusAsync(cookie);
+		if (blocksUse(status))
+			co_return "";
+		auto resp = co_await csrfPostAsync(Routes::url(Routes::Service::Auth, "/v1/authentication-ticket"), cookie);
+		if (resp.status_code < 200 || resp.status_code >= 300)
+			co_return "";
+		co_return HttpClient::headerValue(resp, "rbx-authentication-ticket");
+	}
+
+	class TicketBuffer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Tickets are short-lived and single use. Counted from when the mint
+		// was requested, so a buffered ticket is never older than this.
+		static constexpr std::chrono::seconds kTicketLifetime{60};
+
+		static TicketBuffer &instance() {
+			static TicketBuffer buffer;
+			return buffer;
+		}
+
+		// Starts minting for each cookie that has no fresh or pending ticket.
+		void prefetch(const std::vector<std::string> &cookies) {
+			for (const auto &cookie: cookies)
+				prefetch(cookie);
+		}
+
+		void prefetch(const std::string &cookie) {
+			if (cookie.empty())
+				return;
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = entries_.find(fnv1a64(cookie));
+			if (it != entries_.end() && fresh(it->second))
+				return;
+			entries_[fnv1a64(cookie)] = startMint(cookie);
+		}
+
+		// Hands out the buffered ticket (waiting for it if the mint is still
+		// in flight) or mints one now. Each ticket is given out only once.
+		Async::Task<std::string> take(std::string cookie) {
+			std::optional<Async::Shared<std::string> > pending; {
+				std::lock_guard<std::mutex> lock(mtx_);
+				auto it = entries_.find(fnv1a64(cookie));
+				if (it != entries_.end()) {
+					if (fresh(it->second))
+						pending = it->second.ticket;
+					entries_.erase(it);
+				}
+			}
+			if (pending) {
+				std::string ticket = co_await *pending;
+				if (!ticket.empty()) {
+					++hits_;
+					co_return ticket;
+				}
+			}
+			++misses_;
+			co_return co_await mintAuthTicket(std::move(cookie));
+		}
+
+		uint64_t hits() const { return hits_; }
+		uint64_t misses() const { return misses_; }
+
+	private:
+		struct Entry {
+			Async::Shared<std::string> ticket;
+			Clock::time_point requested;
+		};
+
+		static bool fresh(const Entry &e) {
+			return Clock::now() - e.requested < kTicketLifetime;
+		}
+
+		// Mints run as coroutines, so a batch of them holds no pool threads
+		// while the requests are out.
+		static Entry startMint(const std::string &cookie) {
+			Entry e{Async::Shared<std::string>(), Clock::now()};
+			Async::spawn("tickets.mint", Threading::Priority::Background, fill(e.ticket, cookie));
+			return e;
+		}
+
+		static Async::Task<void> fill(Async::Shared<std::string> ticket, std::string cookie) {
+			std::string minted;
+			try {
+				minted = co_await mintAuthTicket(std::move(cookie));
+			} catch (...) {
+				// Whoever takes this ticket mints a fresh one instead.
+			}
+			ticket.set(std::move(minted));
+		}
+
+		std::mutex mtx_;
+		std::unordered_map<uint64_t, Entry> entries_;
+		std::atomic<uint64_t> hits_{0};
+		std::atomic<uint64_t> misses_{0};
+	};
+}
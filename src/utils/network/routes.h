@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Single place that knows where each Roblox API lives. Call sites ask for
+// Routes::url(Service::Presence, "/v1/presence/users") instead of spelling
+// out a host, so settings can re-point a service at a proxy pool or the
+// whole app at a local mock server.
+//
+// settings.json:
+//   "routes": {
+//     "mock": "http://127.0.0.1:8080",            // optional, wins over everything
+//     "presence": { "bases": ["https://presence.roblox.com", "https://presence.roproxy.com"],
+//                   "strategy": "least-latency" }  // or "round-robin" (default)
+//   }
+namespace Routes {
+	enum class Service {
+		Auth,
+		Users,
+		Presence,
+		Friends,
+		Thumbnails,
+		Games,
+		Apis,
+		Voice,
+		UserModeration,
+		Inventory,
+		Avatar,
+		Www,
+		Count
+	};
+
+	struct ServiceInfo {
+		const char *key; // settings key
+		const char *defaultBase;
+	};
+
+	inline constexpr std::array<ServiceInfo, static_cast<size_t>(Service::Count)> kServices = {{
+		{"auth", "https://auth.roblox.com"},
+		{"users", "https://users.roblox.com"},
+		{"presence", "https://presence.roblox.com"},
+		{"friends", "https://friends.roblox.com"},
+		{"thumbnails", "https://thumbnails.roblox.com"},
+		{"games", "https://games.roblox.com"},
+		{"apis", "https://apis.roblox.com"},
+		{"voice", "https://voice.roblox.com"},
+		{"usermoderation", "https://usermoderation.roblox.com"},
+		{"inventory", "https://inventory.roblox.com"},
+		{"avatar", "https://avatar.roblox.com"},
+		{"www", "https://www.roblox.com"},
+	}};
+
+	enum class Strategy { RoundRobin, LeastLatency };
+
+	class Router {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static Router &instance() {
+			static Router router;
+			return router;
+		}
+
+		// Picks a base URL for the service, skipping upstreams that are
+		// currently marked down. If every upstream is down, the one that
+		// comes back soonest is used.
+		std::string base(Service s) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if (!mockBase_.empty())
+				return mockBase_ + "/" + hostOf(kServices[index(s)].defaultBase);
+
+			Pool &pool = pools_[index(s)];
+			auto now = Clock::now();
+			const size_t n = pool.upstreams.size();
+			Upstream *pick = nullptr;
+
+			if (pool.strategy == Strategy::LeastLatency) {
+				for (auto &u: pool.upstreams) {
+					if (u.downUntil > now)
+						continue;
+					if (!pick || u.ewmaMs < pick->ewmaMs)
+						pick = &u;
+				}
+			} else {
+				for (size_t i = 0; i < n && !pick; ++i) {
+					auto &u = pool.upstreams[(pool.next + i) % n];
+					if (u.downUntil <= now)
+						pick = &u;
+				}
+				pool.next = (pool.next + 1) % n;
+			}
+
+			if (!pick) {
+				pick = &*std::min_element(pool.upstreams.begin(), pool.upstreams.end(),
+				                          [](const Upstream &a, const Upstream &b) { return a.downUntil < b.downUntil; });
+			}
+			return pick->base;
+		}
+
+		// Feeds a finished request back so latency and health stay current.
+		// Transport failures and 5xx count against the upstream; three in a
+		// row take it out of rotation, for longer each time it happens again.
+		void report(const std::string &url, int status, double latencyMs) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			Upstream *u = findLocked(url);
+			if (!u)
+				return;
+			bool failed = status == 0 || status >= 500;
+			if (!failed) {
+				u->ewmaMs = u->samples == 0 ? latencyMs : u->ewmaMs * 0.8 + latencyMs * 0.2;
+				++u->samples;
+				u->consecutiveFailures = 0;
+				u->downCount = 0;
+				return;
+			}
+			if (++u->consecutiveFailures >= kFailuresBeforeDown) {
+				u->consecutiveFailures = 0;
+				u->downCount = std::min(u->downCount + 1, 6);
+				u->downUntil = Clock::now() + std::chrono::seconds(15) * (1 << (u->downCount - 1));
+			}
+		}
+
+		// Same request against a different healthy upstream of the same pool,
+		// used to fail over once after a transport error.
+		std::optional<std::string> alternate(const std::string &url) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto now = Clock::now();
+			for (auto &pool: pools_) {
+				for (auto &u: pool.upstreams) {
+					if (!matches(url, u.base))
+						continue;
+					for (auto &other: pool.upstreams) {
+						if (&other != &u && other.downUntil <= now)
+							return other.base + url.substr(u.base.size());
+					}
+					return std::nullopt;
+				}
+			}
+			return std::nullopt;
+		}
+
+		void setMockBase(std::string base) {
+			while (!base.empty() && base.back() == '/')
+				base.pop_back();
+			std::lock_guard<std::mutex> lock(mtx_);
+			mockBase_ = std::move(base);
+		}
+
+		std::string mockBase() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return mockBase_;
+		}
+
+		void configure(const nlohmann::json &j) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			resetLocked();
+			if (!j.is_object())
+				return;
+			mockBase_ = j.value("mock", "");
+			while (!mockBase_.empty() && mockBase_.back() == '/')
+				mockBase_.pop_back();
+			for (size_t i = 0; i < kServices.size(); ++i) {
+				auto it = j.find(kServices[i].key);
+				if (it == j.end() || !it->is_object())
+					continue;
+				std::vector<Upstream> ups;
+				for (const auto &b: it->value("bases", std::vector<std::string>{})) {
+					Upstream u;
+					u.base = b;
+					while (!u.base.empty() && u.base.back() == '/')
+						u.base.pop_back();
+					if (!u.base.empty())
+						ups.push_back(std::move(u));
+				}
+				if (!ups.empty())
+					pools_[i].upstreams = std::move(ups);
+				pools_[i].strategy = it->value("strategy", "") == "least-latency"
+					                     ? Strategy::LeastLatency
+					                     : Strategy::RoundRobin;
+			}
+		}
+
+		// Only what differs from the defaults, for settings.json.
+		nlohmann::json toJson() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			nlohmann::json j = nlohmann::json::object();
+			if (!mockBase_.empty())
+				j["mock"] = mockBase_;
+			for (size_t i = 0; i < kServices.size(); ++i) {
+				const Pool &pool = pools_[i];
+				bool isDefault = pool.strategy == Strategy::RoundRobin && pool.upstreams.size() == 1 &&
+				                 pool.upstreams[0].base == kServices[i].defaultBase;
+				if (isDefault)
+					continue;
+				std::vector<std::string> bases;
+				for (const auto &u: pool.upstreams)
+					bases.push_back(u.base);
+				j[kServices[i].key] = {
+					{"bases", bases},
+					{"strategy", pool.strategy == Strategy::LeastLatency ? "least-latency" : "round-robin"},
+				};
+			}
+			return j;
+		}
+
+	private:
+		struct Upstream {
+			std::string base;
+			double ewmaMs = 0;
+			uint64_t samples = 0;
+			int consecutiveFailures = 0;
+			int downCount = 0;
+			Clock::time_point downUntil{};
+		};
+
+		struct Pool {
+			std::vector<Upstream> upstreams;
+			Strategy strategy = Strategy::RoundRobin;
+			size_t next = 0;
+		};
+
+		static constexpr int kFailuresBeforeDown = 3;
+
+		Router() { resetLocked(); }
+
+		static size_t index(Service s) { return static_cast<size_t>(s); }
+
+		static std::string hostOf(const std::string &base) {
+			auto p = base.find("://");
+			return p == std::string::npos ? base : base.substr(p + 3);
+		}
+
+		static bool matches(const std::string &url, const std::string &base) {
+			return url.rfind(base, 0) == 0 &&
+			       (url.size() == base.size() || url[base.size()] == '/' || url[base.size()] == '?');
+		}
+
+		void resetLocked() {
+			mockBase_.clear();
+			for (size_t i = 0; i < kServices.size(); ++i) {
+				Upstream u;
+				u.base = kServices[i].defaultBase;
+				pools_[i] = Pool{};
+				pools_[i].upstreams.push_back(std::move(u));
+			}
+		}
+
+		Upstream *findLocked(const std::string &url) {
+			for (auto &pool: pools_) {
+				for (auto &u: pool.upstreams) {
+					if (matches(url, u.base))
+						return &u;
+				}
+			}
+			return nullptr;
+		}
+
+		mutable std::mutex mtx_;
+		std::string mockBase_;
+		std::array<Pool, static_cast<size_t>(Service::Count)> pools_;
+	};
+
+	inline std::string url(Service s, const std::string &path) {
+		return Router::instance().base(s) + path;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HttpClient {
+	// Collapses identical concurrent work into one call. The first caller for a
+	// key becomes the leader and does the work; anyone arriving while it is
+	// still running is parked and receives a copy of the leader's result.
+	// Waiter callbacks run on whichever thread completes the leader.
+	template<typename Result>
+	class SingleFlight {
+	public:
+		using Callback = std::function<void(Result)>;
+
+		// Returns true if the caller became the leader and must call complete()
+		// for `key`; false if `cb` was attached to a call already in flight.
+		bool join(const std::string &key, Callback cb) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = inflight_.find(key);
+			if (it != inflight_.end()) {
+				it->second.push_back(std::move(cb));
+				++saved_;
+				return false;
+			}
+			inflight_[key].push_back(std::move(cb));
+			++leaders_;
+			return true;
+		}
+
+		void complete(const std::string &key, const Result &result) {
+			std::vector<Callback> waiters; {
+				std::lock_guard<std::mutex> lock(mtx_);
+				auto it = inflight_.find(key);
+				if (it == inflight_.end())
+					return;
+				waiters.swap(it->second);
+				inflight_.erase(it);
+			}
+			for (auto &cb: waiters) {
+				if (cb)
+					cb(result);
+			}
+		}
+
+		// Blocking helper: runs `work` if nobody else is, otherwise waits for
+		// the call already in flight.
+		template<typename Work>
+		Result run(const std::string &key, Work &&work) {
+			auto promise = std::make_shared<std::promise<Result> >();
+			auto fut = promise->get_future();
+			bool leader = join(key, [promise](Result r) { promise->set_value(std::move(r)); });
+			if (leader) {
+				try {
+					complete(key, work());
+				} catch (...) {
+					complete(key, Result{});
+					throw;
+				}
+			}
+			return fut.get();
+		}
+
+		uint64_t saved() const { return saved_; }
+		uint64_t leaders() const { return leaders_; }
+
+	private:
+		std::mutex mtx_;
+		std::unordered_map<std::string, std::vector<Callback> > inflight_;
+		std::atomic<uint64_t> saved_{0};
+		std::atomic<uint64_t> leaders_{0};
+	};
+}
@@ -0,0 +1,252 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+using socklen_t = int;
+#else
+// The stub only needs plain BSD sockets, so captures can also be served from
+// a headless Linux box.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SD_BOTH = SHUT_RDWR;
+inline int closesocket(SOCKET s) { return close(s); }
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#include "stub_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+
+namespace {
+	bool ensureWinsock() {
+#ifdef _WIN32
+		static bool ok = [] {
+			WSADATA wsa;
+			return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+		}();
+		return ok;
+#else
+		return true;
+#endif
+	}
+
+	const char *reasonPhrase(int status) {
+		switch (status) {
+			case 200: return "OK";
+			case 204: return "No Content";
+			case 304: return "Not Modified";
+			case 400: return "Bad Request";
+			case 403: return "Forbidden";
+			case 404: return "Not Found";
+			case 429: return "Too Many Requests";
+			case 500: return "Internal Server Error";
+			default: return "Status";
+		}
+	}
+
+	std::string lower(std::string s) {
+		std::transform(s.begin(), s.end(), s.begin(),
+		               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return s;
+	}
+
+	std::string serialize(const StubServer::Response &resp, bool keepAlive) {
+		std::string out = "HTTP/1.1 " + std::to_string(resp.status) + " " + reasonPhrase(resp.status) + "\r\n";
+		out += "Content-Type: " + resp.contentType + "\r\n";
+		out += "Content-Length: " + std::to_string(resp.body.size()) + "\r\n";
+		out += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+		for (const auto &[name, value]: resp.headers)
+			out += name + ": " + value + "\r\n";
+		out += "\r\n";
+		out += resp.body;
+		return out;
+	}
+
+	bool sendAll(SOCKET s, const std::string &data) {
+		size_t sent = 0;
+		while (sent < data.size()) {
+			int n = send(s, data.data() + sent, static_cast<int>(data.size() - sent), MSG_NOSIGNAL);
+			if (n <= 0)
+				return false;
+			sent += static_cast<size_t>(n);
+		}
+		return true;
+	}
+}
+
+namespace StubServer {
+	bool Server::start(Handler handler, uint16_t port) {
+		if (running_ || !ensureWinsock())
+			return false;
+
+		SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (s == INVALID_SOCKET)
+			return false;
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0) {
+			closesocket(s);
+			return false;
+		}
+
+		socklen_t len = sizeof(addr);
+		getsockname(s, reinterpret_cast<sockaddr *>(&addr), &len);
+		port_ = ntohs(addr.sin_port);
+		listener_ = static_cast<uintptr_t>(s);
+		handler_ = std::move(handler);
+		running_ = true;
+		acceptThread_ = std::thread([this] { acceptLoop(); });
+		return true;
+	}
+
+	void Server::stop() {
+		if (!running_.exchange(false))
+			return;
+
+		shutdown(static_cast<SOCKET>(listener_), SD_BOTH);
+		closesocket(static_cast<SOCKET>(listener_));
+		if (acceptThread_.joinable())
+			acceptThread_.join();
+
+		std::vector<std::thread> threads; {
+			std::lock_guard<std::mutex> lock(clientsMtx_);
+			for (uintptr_t c: clients_)
+				shutdown(static_cast<SOCKET>(c), SD_BOTH);
+			for (auto &[client, thread]: clientThreads_)
+				threads.push_back(std::move(thread));
+			clientThreads_.clear();
+			threads.insert(threads.end(), std::make_move_iterator(finished_.begin()),
+			               std::make_move_iterator(finished_.end()));
+			finished_.clear();
+		}
+		for (auto &t: threads) {
+			if (t.joinable())
+				t.join();
+		}
+	}
+
+	void Server::acceptLoop() {
+		while (running_) {
+			SOCKET c = accept(static_cast<SOCKET>(listener_), nullptr, nullptr);
+			if (c == INVALID_SOCKET)
+				break;
+			int noDelay = 1;
+			setsockopt(c, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+
+			// Connections that closed since the last accept are joined here,
+			// so a long run holds one thread per open connection, not per
+			// connection ever made.
+			std::vector<std::thread> done; {
+				std::lock_guard<std::mutex> lock(clientsMtx_);
+				done.swap(finished_);
+				clients_.push_back(static_cast<uintptr_t>(c));
+				clientThreads_.emplace(static_cast<uintptr_t>(c), std::thread([this, c] {
+					serve(static_cast<uintptr_t>(c));
+				}));
+			}
+			for (auto &t: done)
+				t.join();
+		}
+	}
+
+	void Server::serve(uintptr_t client) {
+		SOCKET s = static_cast<SOCKET>(client);
+		std::string buffer;
+		char chunk[8192];
+
+		while (running_) {
+			size_t headerEnd;
+			while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+				int n = recv(s, chunk, sizeof(chunk), 0);
+				if (n <= 0)
+					goto done;
+				buffer.append(chunk, n);
+			}
+
+			Request req;
+			bool keepAlive = true; {
+				std::string head = buffer.substr(0, headerEnd);
+				size_t lineEnd = head.find("\r\n");
+				std::string requestLine = head.substr(0, lineEnd);
+				size_t sp1 = requestLine.find(' ');
+				size_t sp2 = requestLine.find(' ', sp1 + 1);
+				if (sp1 == std::string::npos || sp2 == std::string::npos)
+					break;
+				req.method = requestLine.substr(0, sp1);
+				req.target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+				if (requestLine.compare(sp2 + 1, std::string::npos, "HTTP/1.0") == 0)
+					keepAlive = false;
+
+				size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+				while (pos < head.size()) {
+					size_t next = head.find("\r\n", pos);
+					if (next == std::string::npos)
+						next = head.size();
+					std::string line = head.substr(pos, next - pos);
+					if (auto colon = line.find(':'); colon != std::string::npos) {
+						std::string value = line.substr(colon + 1);
+						value.erase(0, value.find_first_not_of(' '));
+						req.headers[lower(line.substr(0, colon))] = value;
+					}
+					pos = next + 2;
+				}
+			}
+			buffer.erase(0, headerEnd + 4);
+
+			size_t contentLength = 0;
+			if (auto it = req.headers.find("content-length"); it != req.headers.end()) {
+				const std::string &value = it->second;
+				auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+				if (ec != std::errc() || end != value.data() + value.size()) {
+					sendAll(s, serialize(Response{400, "text/plain", "bad Content-Length", {}, 0}, false));
+					break;
+				}
+			}
+			while (buffer.size() < contentLength) {
+				int n = recv(s, chunk, sizeof(chunk), 0);
+				if (n <= 0)
+					goto done;
+				buffer.append(chunk, n);
+			}
+			req.body = buffer.substr(0, contentLength);
+			buffer.erase(0, contentLength);
+			if (auto it = req.headers.find("connection"); it != req.headers.end() && lower(it->second) == "close")
+				keepAlive = false;
+
+			Response resp = handler_ ? handler_(req) : Response{404, "text/plain", "no handler", {}, 0};
+			if (resp.delayMs > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(resp.delayMs));
+
+			++served_;
+			if (!sendAll(s, serialize(resp, keepAlive)) || !keepAlive)
+				break;
+		}
+
+	done: {
+			// Hand our thread over for joining before the socket is closed:
+			// once it is, accept can hand out the same value again.
+			std::lock_guard<std::mutex> lock(clientsMtx_);
+			clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+			if (auto it = clientThreads_.find(client); it != clientThreads_.end()) {
+				finished_.push_back(std::move(it->second));
+				clientThreads_.erase(it);
+			}
+		}
+		closesocket(s);
+	}
+}
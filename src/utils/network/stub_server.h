@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Minimal HTTP/1.1 server bound to 127.0.0.1, used to benchmark and exercise
+// the HTTP stack without touching live endpoints. Each connection is served on
+// its own thread with keep-alive; the handler decides status, body and delay.
+namespace StubServer {
+	struct Request {
+		std::string method;
+		std::string target; // path + query as sent on the request line
+		std::map<std::string, std::string> headers;
+		std::string body;
+	};
+
+	struct Response {
+		int status = 200;
+		std::string contentType = "application/json";
+		std::string body;
+		std::map<std::string, std::string> headers;
+		int delayMs = 0;
+	};
+
+	using Handler = std::function<Response(const Request &)>;
+
+	class Server {
+	public:
+		Server() = default;
+
+		Server(const Server &) = delete;
+
+		Server &operator=(const Server &) = delete;
+
+		~Server() { stop(); }
+
+		// Binds to the given loopback port (0 picks a free one) and starts accepting.
+		bool start(Handler handler, uint16_t port = 0);
+
+		void stop();
+
+		bool running() const { return running_; }
+		uint16_t port() const { return port_; }
+		std::string baseUrl() const { return "http://127.0.0.1:" + std::to_string(port_); }
+		uint64_t requestsServed() const { return served_; }
+
+	private:
+		void acceptLoop();
+
+		void serve(uintptr_t client);
+
+		Handler handler_;
+		uintptr_t listener_ = ~uintptr_t{0};
+		uint16_t port_ = 0;
+		std::atomic<bool> running_{false};
+		std::atomic<uint64_t> served_{0};
+		std::thread acceptThread_;
+
+		std::mutex clientsMtx_;
+		std::vector<uintptr_t> clients_;
+		std::unordered_map<uintptr_t, std::thread> clientThreads_; // by client socket
+		std::vector<std::thread> finished_;                        // serve() returned, not joined yet
+	};
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+#include "http_capture.h"
+#include "http_types.h"
+#include "core/logging.hpp"
+
+namespace HttpClient {
+	enum class TransportMode {
+		Live = 0,      // talk to the real endpoints
+		Record,        // talk to the real endpoints and append every exchange to the capture
+		Replay,        // answer from the capture, sleeping for the recorded latency
+		ReplayInstant, // answer from the capture immediately
+	};
+
+	// Capture file name inside the app's storage directory.
+	inline constexpr const char *kCaptureFileName = "http_capture.jsonl";
+
+	// Response headers worth keeping in a capture: the ones the cache, the
+	// limiter and the JSON decoder read. Everything else is dropped, which
+	// keeps Set-Cookie, x-csrf-token and rbx-authentication-ticket off disk.
+	inline bool capturedHeader(const std::string &name) {
+		static const std::string kKept[] = {"Content-Type", "ETag", "Last-Modified", "Cache-Control", "Retry-After"};
+		for (const auto &kept: kKept) {
+			if (name.size() == kept.size() &&
+			    std::equal(name.begin(), name.end(), kept.begin(), [](char a, char b) {
+				    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+			    }))
+				return true;
+		}
+		return false;
+	}
+
+	inline const char *transportModeName(TransportMode mode) {
+		switch (mode) {
+			case TransportMode::Live: return "Live";
+			case TransportMode::Record: return "Record";
+			case TransportMode::Replay: return "Replay";
+			case TransportMode::ReplayInstant: return "Replay (no latency)";
+		}
+		return "Live";
+	}
+
+	// Decides whether requests hit the network or a capture file. Both the
+	// blocking helpers and the async engine consult it, so everything built on
+	// HttpClient can be recorded once and replayed offline and repeatably.
+	class Transport {
+	public:
+		static Transport &instance() {
+			static Transport transport;
+			return transport;
+		}
+
+		void configure(TransportMode mode, const std::string &capturePath) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			recordFile_.close();
+			capturePath_ = capturePath;
+			missingLogged_.clear();
+
+			if (mode == TransportMode::Record) {
+				recordFile_.open(capturePath_, std::ios::app | std::ios::binary);
+				if (!recordFile_) {
+					LOG_INFO("HTTP transport: cannot open " + capturePath_ + " for recording, staying live");
+					mode = TransportMode::Live;
+				}
+			} else if (mode == TransportMode::Replay || mode == TransportMode::ReplayInstant) {
+				if (!capture_.load(capturePath_)) {
+					LOG_INFO("HTTP transport: no capture at " + capturePath_ + ", staying live");
+					mode = TransportMode::Live;
+				}
+			}
+			mode_ = mode;
+			LOG_INFO(std::string("HTTP transport: ") + transportModeName(mode) +
+				(mode == TransportMode::Live ? "" : " (" + capturePath_ + ", " + std::to_string(capture_.size()) +
+				                                    " exchanges)"));
+		}
+
+		TransportMode mode() const { return mode_; }
+
+		bool replaying() const {
+			return mode_ == TransportMode::Replay || mode_ == TransportMode::ReplayInstant;
+		}
+
+		// Canned answer for `req`. A request that was never recorded gets
+		// status 0, the same as a transport failure on the live path.
+		Response replay(const Request &req, std::chrono::milliseconds &latency) {
+			Response resp;
+			latency = std::chrono::milliseconds::zero();
+			auto e = capture_.next(req.method, req.url, req.body);
+			if (!e) {
+				++missing_;
+				std::lock_guard<std::mutex> lock(mtx_);
+				if (missingLogged_.insert(req.method + ' ' + req.url).second)
+					LOG_INFO("HTTP replay: no capture for " + req.method + " " + req.url);
+				return resp;
+			}
+			++replayed_;
+			resp.status_code = e->status;
+			resp.headers = std::move(e->headers);
+			resp.text = std::move(e->body);
+			resp.uncompressed_bytes = resp.text.size();
+			if (mode_ == TransportMode::Replay)
+				latency = std::chrono::milliseconds(static_cast<int64_t>(e->latencyMs));
+			return resp;
+		}
+
+		void record(const Request &req, const Response &resp, double latencyMs) {
+			if (mode_ != TransportMode::Record)
+				return;
+			Exchange e;
+			e.method = req.method;
+			e.url = req.url;
+			e.requestBody = req.body;
+			e.status = resp.status_code;
+			e.body = resp.text;
+			e.latencyMs = latencyMs;
+			for (const auto &[name, value]: resp.headers) {
+				if (capturedHeader(name))
+					e.headers[name] = value;
+			}
+			std::string line = toJson(e).dump();
+			std::lock_guard<std::mutex> lock(mtx_);
+			if (!recordFile_)
+				return;
+			recordFile_ << line << '\n';
+			recordFile_.flush();
+			++recorded_;
+		}
+
+		uint64_t replayed() const { return replayed_; }
+		uint64_t missing() const { return missing_; }
+		uint64_t recorded() const { return recorded_; }
+
+	private:
+		Transport() = default;
+
+		std::atomic<TransportMode> mode_{TransportMode::Live};
+		std::mutex mtx_;
+		std::string capturePath_;
+		std::ofstream recordFile_;
+		Capture capture_;
+		std::unordered_set<std::string> missingLogged_;
+
+		std::atomic<uint64_t> replayed_{0};
+		std::atomic<uint64_t> missing_{0};
+		std::atomic<uint64_t> recorded_{0};
+	};
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "main_thread.h"
+#include "core/logging.hpp"
+
+// Decides when the render loop may sleep. Right after input, or while work
+// is queued for the UI, frames run at the display rate. Once things go
+// quiet the loop blocks in MsgWaitForMultipleObjectsEx until a window
+// message arrives, something is posted to MainThread, or a slow redraw
+// tick comes due: ten per second in the foreground and one per second in
+// the background or while the window is hidden.
+namespace FramePacer {
+	using Clock = std::chrono::steady_clock;
+
+	// Full-rate rendering continues this long after the last input, so
+	// hover fades and popups finish animating.
+	inline constexpr auto kActiveAfterInput = std::chrono::milliseconds(1000);
+	inline constexpr DWORD kForegroundIdleMs = 100;
+	inline constexpr DWORD kBackgroundIdleMs = 1000;
+	// ImGui lays out new windows over a couple of frames; render this many
+	// after every wake so they settle before the next wait.
+	inline constexpr int kFramesPerWake = 3;
+
+	inline std::atomic<bool> throttle{true};
+	inline std::atomic<uint64_t> frames{0};
+	inline HWND window = nullptr;
+	inline HANDLE wakeEvent = nullptr;
+	inline Clock::time_point lastInput{};
+	inline int framesOwed = kFramesPerWake;
+
+	inline void Init(HWND hwnd) {
+		window = hwnd;
+		wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		MainThread::wakeHook = [] { SetEvent(wakeEvent); };
+	}
+
+	// Posted messages, from the PeekMessage loop.
+	inline void NoteMessage(UINT message) {
+		bool input = (message >= WM_MOUSEFIRST && message <= WM_MOUSELAST) ||
+		             (message >= WM_KEYFIRST && message <= WM_KEYLAST);
+		if (input)
+			lastInput = Clock::now();
+	}
+
+	// Sent messages never pass through the PeekMessage loop, so the WndProc
+	// reports resizes, moves and activation here.
+	inline void NoteWindowMessage(UINT message) {
+		bool change = message == WM_SIZE || message == WM_ACTIVATE || message == WM_DPICHANGED ||
+		              message == WM_WINDOWPOSCHANGED;
+		if (change) {
+			lastInput = Clock::now();
+			framesOwed = kFramesPerWake;
+		}
+	}
+
+	// Blocks until the next frame should be drawn. `hidden` is true while
+	// the swap chain is occluded or the window is minimised.
+	inline void WaitForWork(bool hidden, bool textInputActive) {
+		if (!throttle.load(std::memory_order_relaxed)) {
+			if (hidden)
+				Sleep(10); // what the loop did before it could idle
+			return;
+		}
+		if (!hidden) {
+			if (framesOwed > 0) {
+				--framesOwed;
+				return;
+			}
+			if (Clock::now() - lastInput < kActiveAfterInput || MainThread::depth.load() > 0)
+				return;
+		}
+
+		// Hidden windows still time out now and then so a restore that
+		// somehow sends no message is noticed.
+		DWORD timeout = kBackgroundIdleMs;
+		if (!hidden && (GetForegroundWindow() == window || textInputActive))
+			timeout = kForegroundIdleMs;
+		DWORD r = MsgWaitForMultipleObjectsEx(1, &wakeEvent, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+		framesOwed = r == WAIT_TIMEOUT ? 0 : kFramesPerWake - 1;
+	}
+
+	inline void FrameRendered() {
+		frames.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline double ProcessCpuSeconds() {
+		FILETIME created, exited, kernel, user;
+		if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+			return 0;
+		auto toSeconds = [](const FILETIME &ft) {
+			ULARGE_INTEGER v;
+			v.LowPart = ft.dwLowDateTime;
+			v.HighPart = ft.dwHighDateTime;
+			return v.QuadPart / 1e7;
+		};
+		return toSeconds(kernel) + toSeconds(user);
+	}
+
+	// Process CPU and frame rate over `seconds` of whatever the loop is
+	// doing; CPU is given as a share of one core.
+	inline void Sample(const char *label, int seconds) {
+		double cpu0 = ProcessCpuSeconds();
+		uint64_t frames0 = frames.load();
+		auto t0 = Clock::now();
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+		double wall = std::chrono::duration<double>(Clock::now() - t0).count();
+		double cpu = ProcessCpuSeconds() - cpu0;
+		char buf[160];
+		snprintf(buf, sizeof(buf), "Idle CPU [%s]: %.2f%% of one core, %.1f fps over %.0f s", label,
+		         100.0 * cpu / wall, (frames.load() - frames0) / wall, wall);
+		LOG_INFO(buf);
+	}
+
+	// Diagnostics > Measure Idle CPU. Samples the same idle window with
+	// throttling off (the old always-render loop) and on. Blocks for about
+	// 25 s; don't touch the window meanwhile.
+	inline void MeasureIdleCpu(int secondsEach = 10) {
+		LOG_INFO("Idle CPU: measuring for about " + std::to_string(secondsEach * 2 + 4) +
+			" s, leave the window alone");
+		bool previous = throttle.exchange(false);
+		MainThread::Wake();
+		std::this_thread::sleep_for(std::chrono::seconds(2));
+		Sample("always render", secondsEach);
+		throttle = true;
+		MainThread::Wake();
+		std::this_thread::sleep_for(std::chrono::seconds(2));
+		Sample("idle throttled", secondsEach);
+		throttle = previous;
+		MainThread::Wake();
+	}
+}
@@ -1,4 +1,6 @@
 ﻿#include "network/http.hpp"
+#include "network/roblox/tickets.h"
+#include "system/task.h"
 #include <windows.h>
 #include <iostream>
 #include <chrono>
@@ -27,39 +29,21 @@ static string urlEncode(const string &s) {
 	return out.str();
 }
 
-inline HANDLE startRoblox(uint64_t placeId, const string &jobId, const string &cookie) {
-	// Status::Set("Fetching x-csrf token"); // REMOVE THIS
-	LOG_INFO("Fetching x-csrf token");
-	auto csrfResponse = HttpClient::post(
-		"https://auth.roblox.com/v1/authentication-ticket",
-		{{"Cookie", ".ROBLOSECURITY=" + cookie}});
-
-	auto csrfToken = csrfResponse.headers.find("x-csrf-token");
-	if (csrfToken == csrfResponse.headers.end()) {
-		cerr << "failed to get CSRF token\n";
-
-		// Status::Set("Failed to get CSRF token"); // REMOVE THIS
-		LOG_ERROR("Failed to get CSRF token"); // This will now set the status
-		return nullptr;
+inline Async::Task<HANDLE> startRoblox(uint64_t placeId, string jobId, string cookie) {
+	Roblox::BanCheckResult status = co_await Roblox::cachedBanStatusAsync(cookie);
+	if (Roblox::blocksUse(status)) {
+		LOG_ERROR(status == Roblox::BanCheckResult::InvalidCookie
+			          ? "Skipping launch: invalid cookie"
+			          : "Skipping launch: account is banned or terminated");
+		co_return nullptr;
 	}
 
-	// Status::Set("Fetching authentication ticket"); // REMOVE THIS
-	LOG_INFO("Fetching authentication ticket"); // This will now set the status
-	auto ticketResponse = HttpClient::post(
-		"https://auth.roblox.com/v1/authentication-ticket",
-		{
-			{"Cookie", ".ROBLOSECURITY=" + cookie},
-			{"Origin", "https://www.roblox.com"},
-			{"Referer", "https://www.roblox.com/"},
-			{"X-CSRF-TOKEN", csrfToken->second}
-		});
-
-	auto ticket = ticketResponse.headers.find("rbx-authentication-ticket");
-	if (ticket == ticketResponse.headers.end()) {
+	LOG_INFO("Fetching authentication ticket");
+	string ticket = co_await Roblox::TicketBuffer::instance().take(cookie);
+	if (ticket.empty()) {
 		cerr << "failed to get authentication ticket\n";
-		// Status::Set("Failed to get authentication ticket"); // REMOVE THIS
-		LOG_ERROR("Failed to get authentication ticket"); // This will now set the status
-		return nullptr;
+		LOG_ERROR("Failed to get authentication ticket");
+		co_return nullptr;
 	}
 
 	auto nowMs = duration_cast<milliseconds>(
@@ -84,7 +68,7 @@ inline HANDLE startRoblox(uint64_t placeId, const string &jobId, const string &c
 	string protocolLaunchCommand =
 			"roblox-player:1+launchmode:play"
 			"+gameinfo:" +
-			ticket->second +
+			ticket +
 			"+launchtime:" + ts.str() +
 			"+placelauncherurl:" + urlEncode(placeLauncherUrl);
 
@@ -110,28 +94,40 @@ inline HANDLE startRoblox(uint64_t placeId, const string &jobId, const string &c
 	if (!ShellExecuteExA(&executionInfo)) {
 		LOG_ERROR("ShellExecuteExA failed for Roblox launch. Error: " + to_string(GetLastError()));
 		cerr << "ShellExecuteEx failed: " << GetLastError() << "\n";
-		return nullptr;
+		co_return nullptr;
 	}
 
 	LOG_INFO("Roblox process started successfully for place ID: " + to_string(placeId));
-	return executionInfo.hProcess;
+	co_return executionInfo.hProcess;
 }
 
-inline void launchRobloxSequential(uint64_t placeId, const std::string &jobId,
-                                   const std::vector<std::pair<int, std::string> > &accounts) {
+// Launches each account in turn, waiting for its client to come up before
+// starting the next. While it waits on a ticket or a client starting up
+// the flow holds no thread.
+inline Async::Task<void> launchRoblox(uint64_t placeId, std::string jobId,
+                                      std::vector<std::pair<int, std::string> > accounts) {
+	// Mint every ticket up front so the loop below only waits on process startup.
+	std::vector<std::string> cookies;
+	for (const auto &account: accounts)
+		cookies.push_back(account.second);
+	Roblox::TicketBuffer::instance().prefetch(cookies);
+
 	if (g_killRobloxOnLaunch)
 		RobloxControl::KillRobloxProcesses();
 
 	if (g_clearCacheOnLaunch)
 		RobloxControl::ClearRobloxCache();
 
-	for (const auto &[accountId, cookie]: accounts) {
+	for (const auto &account: accounts) {
+		int accountId = account.first;
 		LOG_INFO("Launching Roblox for account ID: " + std::to_string(accountId) +
 			" PlaceID: " + std::to_string(placeId) +
 			(jobId.empty() ? "" : " JobID: " + jobId));
-		HANDLE proc = startRoblox(placeId, jobId, cookie);
+		HANDLE proc = co_await startRoblox(placeId, jobId, account.second);
 		if (proc) {
-			WaitForInputIdle(proc, INFINITE);
+			// Polled so no thread sits in WaitForInputIdle(INFINITE).
+			while (WaitForInputIdle(proc, 0) == WAIT_TIMEOUT)
+				co_await Async::sleepFor(milliseconds(100));
 			CloseHandle(proc);
 			LOG_INFO("Roblox launched successfully for account ID: " +
 				std::to_string(accountId));
@@ -141,3 +137,9 @@ inline void launchRobloxSequential(uint64_t placeId, const std::string &jobId,
 		}
 	}
 }
+
+// Starts the launch and returns straight away; safe from the UI thread.
+inline void launchRobloxSequential(uint64_t placeId, const std::string &jobId,
+                                   const std::vector<std::pair<int, std::string> > &accounts) {
+	Async::spawn("launch", Threading::Priority::Interactive, launchRoblox(placeId, jobId, accounts));
+}
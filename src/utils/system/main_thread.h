@@ -1,25 +1,232 @@
 #pragma once
-#include <functional>
-#include <deque>
-#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace MainThread {
-	using Task = std::function<void()>;
-	inline std::deque<Task> tasks;
-	inline std::mutex mtx;
+	// Move-only callable. Captures up to kInlineSize bytes live inside the
+	// task, so posting a typical lambda costs one allocation (the queue
+	// node) rather than a node plus a std::function heap block.
+	class Task {
+	public:
+		static constexpr size_t kInlineSize = 64;
+
+		Task() = default;
+
+		template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task> > >
+		Task(F &&f) {
+			using Fn = std::decay_t<F>;
+			if constexpr (fitsInline<Fn>()) {
+				new(storage_) Fn(std::forward<F>(f));
+				ops_ = &inlineOps<Fn>;
+			} else {
+				*reinterpret_cast<Fn **>(storage_) = new Fn(std::forward<F>(f));
+				ops_ = &heapOps<Fn>;
+			}
+		}
+
+		Task(Task &&other) noexcept { moveFrom(other); }
+
+		Task &operator=(Task &&other) noexcept {
+			if (this != &other) {
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		Task(const Task &) = delete;
+		Task &operator=(const Task &) = delete;
+
+		~Task() { reset(); }
+
+		explicit operator bool() const { return ops_ != nullptr; }
+
+		void operator()() { ops_->invoke(storage_); }
+
+	private:
+		struct Ops {
+			void (*invoke)(void *);
+			void (*move)(void *dst, void *src); // leaves src destroyed
+			void (*destroy)(void *);
+		};
+
+		template<typename Fn>
+		static constexpr bool fitsInline() {
+			return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t) &&
+			       std::is_nothrow_move_constructible_v<Fn>;
+		}
+
+		template<typename Fn>
+		static constexpr Ops inlineOps = {
+			[](void *p) { (*static_cast<Fn *>(p))(); },
+			[](void *dst, void *src) {
+				new(dst) Fn(std::move(*static_cast<Fn *>(src)));
+				static_cast<Fn *>(src)->~Fn();
+			},
+			[](void *p) { static_cast<Fn *>(p)->~Fn(); },
+		};
+
+		template<typename Fn>
+		static constexpr Ops heapOps = {
+			[](void *p) { (**static_cast<Fn **>(p))(); },
+			[](void *dst, void *src) { *static_cast<Fn **>(dst) = *static_cast<Fn **>(src); },
+			[](void *p) { delete *static_cast<Fn **>(p); },
+		};
+
+		void moveFrom(Task &other) {
+			ops_ = other.ops_;
+			if (ops_)
+				ops_->move(storage_, other.storage_);
+			other.ops_ = nullptr;
+		}
+
+		void reset() {
+			if (ops_)
+				ops_->destroy(storage_);
+			ops_ = nullptr;
+		}
+
+		alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+		const Ops *ops_ = nullptr;
+	};
+
+	// Intrusive multi-producer, single-consumer queue (Vyukov). Producers
+	// never block: a push is one exchange and one store. Only the render
+	// thread pops. A pop racing a half-finished push sees the queue as empty
+	// and picks the item up next frame.
+	class Queue {
+	public:
+		struct Node {
+			std::atomic<Node *> next{nullptr};
+			Task task;
+		};
+
+		Queue() : head_(&stub_), tail_(&stub_) {}
+
+		void push(Node *node) {
+			node->next.store(nullptr, std::memory_order_relaxed);
+			Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		Node *pop() {
+			Node *tail = tail_;
+			Node *next = tail->next.load(std::memory_order_acquire);
+			if (tail == &stub_) {
+				if (!next)
+					return nullptr;
+				tail_ = next;
+				tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+			if (next) {
+				tail_ = next;
+				return tail;
+			}
+			if (tail != head_.load(std::memory_order_acquire))
+				return nullptr; // a producer is between its exchange and store
+			push(&stub_);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next) {
+				tail_ = next;
+				return tail;
+			}
+			return nullptr;
+		}
+
+	private:
+		std::atomic<Node *> head_;
+		Node *tail_;
+		Node stub_;
+	};
+
+	struct Stats {
+		uint64_t posted = 0;
+		uint64_t run = 0;
+		size_t depth = 0; // queued right now
+		size_t maxDepth = 0;
+		uint64_t overruns = 0;       // frames whose drain used up the budget
+		uint64_t deferredFrames = 0; // ...and left work for the next one
+		double maxDrainMs = 0;
+	};
+
+	inline Queue queue;
+	inline std::atomic<size_t> depth{0};
+	inline std::atomic<size_t> maxDepth{0};
+	inline std::atomic<uint64_t> posted{0};
+	inline std::atomic<uint64_t> run{0};
+	inline std::atomic<uint64_t> deferredFrames{0};
+	inline std::atomic<uint64_t> overruns{0};
+	inline std::atomic<double> maxDrainMs{0};
+	inline std::atomic<int64_t> budgetMicros{4000};
+	// Set by the render loop so a post can end an idle wait.
+	inline std::atomic<void (*)()> wakeHook{nullptr};
+
+	inline void SetFrameBudget(std::chrono::microseconds budget) {
+		budgetMicros = budget.count();
+	}
+
+	// Asks the render loop for a frame without queuing anything.
+	inline void Wake() {
+		if (auto hook = wakeHook.load(std::memory_order_acquire))
+			hook();
+	}
 
 	inline void Post(Task t) {
-		std::lock_guard<std::mutex> lock(mtx);
-		tasks.push_back(std::move(t));
+		auto *node = new Queue::Node;
+		node->task = std::move(t);
+		size_t d = depth.fetch_add(1, std::memory_order_relaxed) + 1;
+		size_t seen = maxDepth.load(std::memory_order_relaxed);
+		while (d > seen && !maxDepth.compare_exchange_weak(seen, d, std::memory_order_relaxed)) {
+		}
+		posted.fetch_add(1, std::memory_order_relaxed);
+		queue.push(node);
+		Wake();
 	}
 
+	// Runs queued tasks until the frame budget is spent; the rest wait for
+	// the next frame. At least one task runs per call so a slow one can't
+	// wedge the queue.
 	inline void Process() {
-		std::deque<Task> toRun; {
-			std::lock_guard<std::mutex> lock(mtx);
-			toRun.swap(tasks);
-		}
-		for (auto &t: toRun) {
-			t();
+		using Clock = std::chrono::steady_clock;
+		auto start = Clock::now();
+		auto deadline = start + std::chrono::microseconds(budgetMicros.load(std::memory_order_relaxed));
+		bool outOfTime = false;
+		while (Queue::Node *node = queue.pop()) {
+			node->task();
+			delete node;
+			depth.fetch_sub(1, std::memory_order_relaxed);
+			run.fetch_add(1, std::memory_order_relaxed);
+			if (Clock::now() >= deadline) {
+				outOfTime = true;
+				break;
+			}
 		}
+		if (!outOfTime)
+			return;
+
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		overruns.fetch_add(1, std::memory_order_relaxed);
+		if (depth.load(std::memory_order_relaxed) > 0)
+			deferredFrames.fetch_add(1, std::memory_order_relaxed);
+		if (ms > maxDrainMs.load(std::memory_order_relaxed))
+			maxDrainMs.store(ms, std::memory_order_relaxed);
+	}
+
+	inline Stats GetStats() {
+		Stats s;
+		s.posted = posted.load(std::memory_order_relaxed);
+		s.run = run.load(std::memory_order_relaxed);
+		s.depth = depth.load(std::memory_order_relaxed);
+		s.maxDepth = maxDepth.load(std::memory_order_relaxed);
+		s.deferredFrames = deferredFrames.load(std::memory_order_relaxed);
+		s.overruns = overruns.load(std::memory_order_relaxed);
+		s.maxDrainMs = maxDrainMs.load(std::memory_order_relaxed);
+		return s;
 	}
 }
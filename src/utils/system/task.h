@@ -0,0 +1,498 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "main_thread.h"
+#include "threading.h"
+#include "timers.h"
+
+// Coroutines for flows that make several requests in a row. A Task<T> is
+// lazy: nothing runs until it is co_awaited, spawned or waited on. While it
+// waits on the network, a timer, a semaphore or another flow it holds no
+// thread, and it carries on from a pool worker, or from the UI thread after
+// co_await toMainThread(). The cancel token and pool priority of the flow
+// travel with it across those hops, so scoped work stays scoped.
+namespace Async {
+	using Threading::Priority;
+
+	struct Stats {
+		std::atomic<uint64_t> created{0};
+		std::atomic<uint64_t> live{0};     // running or suspended right now
+		std::atomic<uint64_t> hops{0};     // resumed from another thread or later
+		std::atomic<uint64_t> failures{0}; // spawned flows that threw
+	};
+
+	inline Stats stats;
+
+	namespace detail {
+		inline Priority &currentPriority() {
+			thread_local Priority priority = Priority::Background;
+			return priority;
+		}
+	}
+
+	// What a suspended coroutine takes to the thread that resumes it.
+	struct Context {
+		Threading::CancelToken token;
+		Priority priority = Priority::Background;
+
+		static Context current() { return {Threading::currentToken(), detail::currentPriority()}; }
+
+		// Resumes `h` on the calling thread with this context current.
+		void resume(std::coroutine_handle<> h) const {
+			Threading::WithToken scoped(token);
+			Priority previous = std::exchange(detail::currentPriority(), priority);
+			h.resume();
+			detail::currentPriority() = previous;
+		}
+	};
+
+	// Queues `h` on the pool at the flow's priority. `name` labels the hop
+	// in the pool's task stats and must be a string literal.
+	inline void resumeOnPool(const char *name, std::coroutine_handle<> h, Context ctx) {
+		stats.hops.fetch_add(1, std::memory_order_relaxed);
+		Priority priority = ctx.priority;
+		Threading::Pool::instance().submit(name, priority, [h, ctx = std::move(ctx)] { ctx.resume(h); });
+	}
+
+	namespace detail {
+		struct PromiseBase {
+			PromiseBase() {
+				stats.created.fetch_add(1, std::memory_order_relaxed);
+				stats.live.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			~PromiseBase() { stats.live.fetch_sub(1, std::memory_order_relaxed); }
+
+			struct FinalAwaiter {
+				bool await_ready() const noexcept { return false; }
+
+				template<typename P>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+					return h.promise().continuation;
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			void unhandled_exception() noexcept { error = std::current_exception(); }
+
+			std::coroutine_handle<> continuation = std::noop_coroutine();
+			std::exception_ptr error;
+		};
+
+		template<typename T>
+		struct Promise : PromiseBase {
+			template<typename U>
+			void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+
+			T result() {
+				if (error)
+					std::rethrow_exception(error);
+				return std::move(*value);
+			}
+
+			std::optional<T> value;
+		};
+
+		template<>
+		struct Promise<void> : PromiseBase {
+			void return_void() const noexcept {}
+
+			void result() const {
+				if (error)
+					std::rethrow_exception(error);
+			}
+		};
+
+		// Frame that frees itself when it finishes; the starting point of
+		// every flow nobody co_awaits. Bodies catch everything.
+		struct Detached {
+			struct promise_type {
+				Detached get_return_object() const noexcept { return {}; }
+				std::suspend_never initial_suspend() const noexcept { return {}; }
+				std::suspend_never final_suspend() const noexcept { return {}; }
+				void return_void() const noexcept {}
+				void unhandled_exception() const noexcept { std::terminate(); }
+			};
+		};
+
+		// Moves the coroutine onto the pool under an explicit context.
+		struct Schedule {
+			// A constructor rather than brace-init: GCC destroys aggregate
+			// temporaries in a co_await expression twice.
+			Schedule(const char *name, Context ctx) : name(name), ctx(std::move(ctx)) {}
+
+			const char *name;
+			Context ctx;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> h) { resumeOnPool(name, h, std::move(ctx)); }
+			void await_resume() const noexcept {}
+		};
+	}
+
+	// Result of a coroutine, or the exception it threw, handed over when it
+	// is co_awaited. Owns the frame; a task that is never awaited never runs.
+	template<typename T = void>
+	class [[nodiscard]] Task {
+	public:
+		struct promise_type : detail::Promise<T> {
+			Task get_return_object() noexcept {
+				return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+		};
+
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Task() = default;
+
+		Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+		Task &operator=(Task &&other) noexcept {
+			if (this != &other) {
+				if (handle_)
+					handle_.destroy();
+				handle_ = std::exchange(other.handle_, nullptr);
+			}
+			return *this;
+		}
+
+		Task(const Task &) = delete;
+		Task &operator=(const Task &) = delete;
+
+		~Task() {
+			if (handle_)
+				handle_.destroy();
+		}
+
+		explicit operator bool() const { return static_cast<bool>(handle_); }
+
+		// Starts the task on the awaiting thread; the awaiter continues on
+		// whichever thread the task finishes on.
+		auto operator co_await() const noexcept {
+			struct Awaiter {
+				Handle h;
+
+				bool await_ready() const noexcept { return false; }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) const noexcept {
+					h.promise().continuation = caller;
+					return h;
+				}
+
+				T await_resume() const { return h.promise().result(); }
+			};
+			return Awaiter{handle_};
+		}
+
+	private:
+		explicit Task(Handle h) : handle_(h) {}
+
+		Handle handle_;
+	};
+
+	// Continues on a pool worker. `name` must be a string literal.
+	inline auto toPool(const char *name) {
+		struct Awaiter {
+			const char *name;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> h) const { resumeOnPool(name, h, Context::current()); }
+			void await_resume() const noexcept {}
+		};
+		return Awaiter{name};
+	}
+
+	// Continues on the UI thread when it next drains MainThread. Keep what
+	// runs there short and co_await toPool() before anything slow. Unlike
+	// postScoped the step is never dropped, since the flow has to finish
+	// either way; check Threading::cancelled() before touching UI state.
+	inline auto toMainThread() {
+		struct Awaiter {
+			bool await_ready() const noexcept { return false; }
+
+			void await_suspend(std::coroutine_handle<> h) const {
+				stats.hops.fetch_add(1, std::memory_order_relaxed);
+				MainThread::Post([h, ctx = Context::current()] { ctx.resume(h); });
+			}
+
+			void await_resume() const noexcept {}
+		};
+		return Awaiter{};
+	}
+
+	// Suspends on the timer wheel, so to its 50 ms resolution.
+	inline auto sleepUntil(Timers::Clock::time_point until) {
+		struct Awaiter {
+			Timers::Clock::time_point until;
+
+			bool await_ready() const { return until <= Timers::Clock::now(); }
+
+			void await_suspend(std::coroutine_handle<> h) const {
+				stats.hops.fetch_add(1, std::memory_order_relaxed);
+				Context ctx = Context::current();
+				Priority priority = ctx.priority;
+				Timers::at("async.sleep", until, [h, ctx = std::move(ctx)] { ctx.resume(h); }, priority);
+			}
+
+			void await_resume() const noexcept {}
+		};
+		return Awaiter{until};
+	}
+
+	inline auto sleepFor(Timers::Clock::duration delay) {
+		return sleepUntil(Timers::Clock::now() + delay);
+	}
+
+	namespace detail {
+		inline Detached launch(const char *name, Context ctx, Task<void> task) {
+			try {
+				co_await Schedule(name, std::move(ctx));
+				co_await task;
+			} catch (...) {
+				stats.failures.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		template<typename T>
+		Detached settle(const char *name, Context ctx, Task<T> task, std::promise<T> promise) {
+			try {
+				co_await Schedule(name, std::move(ctx));
+				if constexpr (std::is_void_v<T>) {
+					co_await task;
+					promise.set_value();
+				} else {
+					promise.set_value(co_await task);
+				}
+			} catch (...) {
+				promise.set_exception(std::current_exception());
+			}
+		}
+	}
+
+	// Starts a flow on the pool and lets it run to completion on its own,
+	// in the calling thread's cancel scope. Exceptions are counted in
+	// stats and dropped, as the pool does for tasks.
+	inline void spawn(const char *name, Priority priority, Task<void> task) {
+		detail::launch(name, Context{Threading::currentToken(), priority}, std::move(task));
+	}
+
+	// Runs a flow on the pool and blocks until it finishes, rethrowing what
+	// it threw. On a pool worker it runs other tasks meanwhile, like
+	// Threading::wait. For synchronous callers of coroutine code.
+	template<typename T>
+	T wait(const char *name, Priority priority, Task<T> task) {
+		std::promise<T> promise;
+		auto future = promise.get_future();
+		detail::settle(name, Context{Threading::currentToken(), priority}, std::move(task), std::move(promise));
+		Threading::wait(future);
+		return future.get();
+	}
+
+	// co_await whenAll(tasks) runs the tasks side by side and continues once
+	// every one has finished. Each starts on the awaiting thread and runs
+	// there until it first suspends. A task that throws is counted in stats
+	// and otherwise ignored, so handle errors inside when they matter.
+	class AllOf {
+	public:
+		explicit AllOf(std::vector<Task<void> > tasks) : tasks_(std::move(tasks)) {}
+
+		AllOf(const AllOf &) = delete;
+		AllOf &operator=(const AllOf &) = delete;
+
+		bool await_ready() const noexcept { return tasks_.empty(); }
+
+		bool await_suspend(std::coroutine_handle<> h) {
+			parent_ = h;
+			ctx_ = Context::current();
+			// One extra count for this loop, so a task finishing early can't
+			// resume the parent while tasks are still being started.
+			remaining_.store(tasks_.size() + 1, std::memory_order_relaxed);
+			for (auto &task: tasks_)
+				child(std::move(task), this);
+			return !arrive();
+		}
+
+		void await_resume() const noexcept {}
+
+	private:
+		bool arrive() { return remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+		static detail::Detached child(Task<void> task, AllOf *all) {
+			try {
+				co_await task;
+			} catch (...) {
+				stats.failures.fetch_add(1, std::memory_order_relaxed);
+			}
+			if (all->arrive())
+				resumeOnPool("async.join", all->parent_, all->ctx_);
+		}
+
+		std::vector<Task<void> > tasks_;
+		std::atomic<size_t> remaining_{0};
+		std::coroutine_handle<> parent_;
+		Context ctx_;
+	};
+
+	inline AllOf whenAll(std::vector<Task<void> > tasks) {
+		return AllOf(std::move(tasks));
+	}
+
+	// Counting semaphore that suspends instead of blocking. A released
+	// permit goes straight to the longest waiter.
+	class Semaphore {
+	public:
+		class Permit {
+		public:
+			explicit Permit(Semaphore *owner) : owner_(owner) {}
+
+			Permit(Permit &&other) noexcept : owner_(std::exchange(other.owner_, nullptr)) {}
+
+			Permit(const Permit &) = delete;
+			Permit &operator=(const Permit &) = delete;
+			Permit &operator=(Permit &&) = delete;
+
+			~Permit() {
+				if (owner_)
+					owner_->release();
+			}
+
+		private:
+			Semaphore *owner_;
+		};
+
+		explicit Semaphore(size_t permits) : free_(permits) {}
+
+		// co_await acquire() yields a Permit that gives the slot back when
+		// it goes out of scope.
+		auto acquire() {
+			struct Awaiter {
+				Semaphore &s;
+
+				bool await_ready() const noexcept { return false; }
+
+				bool await_suspend(std::coroutine_handle<> h) const {
+					std::lock_guard<std::mutex> lock(s.mtx_);
+					if (s.free_ > 0) {
+						--s.free_;
+						return false;
+					}
+					s.waiters_.push_back({h, Context::current()});
+					return true;
+				}
+
+				Permit await_resume() const noexcept { return Permit(&s); }
+			};
+			return Awaiter{*this};
+		}
+
+	private:
+		struct Waiter {
+			std::coroutine_handle<> h;
+			Context ctx;
+		};
+
+		void release() {
+			Waiter next; {
+				std::lock_guard<std::mutex> lock(mtx_);
+				if (waiters_.empty()) {
+					++free_;
+					return;
+				}
+				next = std::move(waiters_.front());
+				waiters_.pop_front();
+			}
+			resumeOnPool("async.semaphore", next.h, std::move(next.ctx));
+		}
+
+		std::mutex mtx_;
+		size_t free_;
+		std::deque<Waiter> waiters_;
+	};
+
+	// A value produced once and awaited by any number of flows: a
+	// shared_future that suspends instead of blocking. Copies share it.
+	template<typename T>
+	class Shared {
+	public:
+		Shared() : state_(std::make_shared<State>()) {}
+
+		void set(T value) {
+			std::vector<Waiter> waiters; {
+				std::lock_guard<std::mutex> lock(state_->mtx);
+				state_->value = std::move(value);
+				waiters.swap(state_->waiters);
+			}
+			for (auto &w: waiters)
+				resumeOnPool("async.shared", w.h, std::move(w.ctx));
+		}
+
+		bool ready() const {
+			std::lock_guard<std::mutex> lock(state_->mtx);
+			return state_->value.has_value();
+		}
+
+		auto operator co_await() const noexcept {
+			struct Awaiter {
+				std::shared_ptr<State> state;
+
+				bool await_ready() const noexcept { return false; }
+
+				bool await_suspend(std::coroutine_handle<> h) const {
+					std::lock_guard<std::mutex> lock(state->mtx);
+					if (state->value)
+						return false;
+					state->waiters.push_back({h, Context::current()});
+					return true;
+				}
+
+				T await_resume() const {
+					std::lock_guard<std::mutex> lock(state->mtx);
+					return *state->value;
+				}
+			};
+			return Awaiter{state_};
+		}
+
+	private:
+		struct Waiter {
+			std::coroutine_handle<> h;
+			Context ctx;
+		};
+
+		struct State {
+			mutable std::mutex mtx;
+			std::optional<T> value;
+			std::vector<Waiter> waiters;
+		};
+
+		std::shared_ptr<State> state_;
+	};
+
+	inline std::string describe() {
+		char buf[160];
+		snprintf(buf, sizeof(buf), "%llu live, %llu started, %llu hops, %llu threw",
+		         static_cast<unsigned long long>(stats.live.load()),
+		         static_cast<unsigned long long>(stats.created.load()),
+		         static_cast<unsigned long long>(stats.hops.load()),
+		         static_cast<unsigned long long>(stats.failures.load()));
+		return buf;
+	}
+}
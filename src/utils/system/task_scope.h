@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "main_thread.h"
+#include "threading.h"
+
+namespace Threading {
+	struct ScopeStats {
+		std::atomic<uint64_t> resets{0};
+		std::atomic<uint64_t> skipped{0}; // queued tasks never started
+		std::atomic<uint64_t> dropped{0}; // UI updates thrown away
+	};
+
+	inline ScopeStats scopeStats;
+
+	// MainThread::Post for scoped work: the update is dropped if the work's
+	// scope is reset before it gets to run. Outside scoped work it posts
+	// unconditionally.
+	inline void postScoped(MainThread::Task task) {
+		CancelToken token = currentToken();
+		if (!token.cancellable()) {
+			MainThread::Post(std::move(task));
+			return;
+		}
+		if (token.cancelled()) {
+			scopeStats.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		MainThread::Post([token = std::move(token), task = std::move(task)]() mutable {
+			if (token.cancelled()) {
+				scopeStats.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			task();
+		});
+	}
+
+	// Background work started on behalf of one context, such as the account
+	// a tab is showing. reset() cancels everything started since the last
+	// reset: queued tasks are skipped, their HTTP requests are aborted or
+	// never sent, and their postScoped updates are dropped. Async HTTP
+	// submitted inside a WithToken(scope.token()) block is covered too.
+	// Owned and driven by the UI thread.
+	class TaskScope {
+	public:
+		TaskScope() : flag_(std::make_shared<std::atomic<bool> >(false)) {}
+
+		TaskScope(const TaskScope &) = delete;
+		TaskScope &operator=(const TaskScope &) = delete;
+
+		~TaskScope() { flag_->store(true, std::memory_order_release); }
+
+		void reset() {
+			flag_->store(true, std::memory_order_release);
+			flag_ = std::make_shared<std::atomic<bool> >(false);
+			scopeStats.resets.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		CancelToken token() const { return CancelToken(flag_); }
+
+		template<typename Func, typename... Args>
+		void submit(const char *name, Priority priority, Func &&f, Args &&... args) {
+			Threading::submit(
+				name, priority,
+				[token = token(), fn = std::forward<Func>(f),
+					tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+					if (token.cancelled()) {
+						scopeStats.skipped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+					WithToken scoped(token);
+					std::apply(fn, tup);
+				});
+		}
+
+		template<typename Func, typename... Args>
+		void interactive(const char *name, Func &&f, Args &&... args) {
+			submit(name, Priority::Interactive, std::forward<Func>(f), std::forward<Args>(args)...);
+		}
+
+		template<typename Func, typename... Args>
+		void background(const char *name, Func &&f, Args &&... args) {
+			submit(name, Priority::Background, std::forward<Func>(f), std::forward<Args>(args)...);
+		}
+
+	private:
+		std::shared_ptr<std::atomic<bool> > flag_;
+	};
+
+	inline std::string describeScopes() {
+		char buf[160];
+		snprintf(buf, sizeof(buf), "%llu context switches; %llu queued tasks skipped, %llu UI updates dropped",
+		         static_cast<unsigned long long>(scopeStats.resets.load()),
+		         static_cast<unsigned long long>(scopeStats.skipped.load()),
+		         static_cast<unsigned long long>(scopeStats.dropped.load()));
+		return buf;
+	}
+}
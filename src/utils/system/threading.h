@@ -1,9 +1,417 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
+
+#include "core/logging.hpp"
 
 namespace Threading {
-	// Launches f(args...) on a detached background thread.
+	enum class Priority {
+		Interactive, // the user is waiting on it: clicks, launches, joins
+		Background,  // thumbnails, prefetches, anything that can queue
+	};
+
+	// Read side of a cancellation flag; see TaskScope. A default token is
+	// never cancelled.
+	class CancelToken {
+	public:
+		CancelToken() = default;
+
+		explicit CancelToken(std::shared_ptr<const std::atomic<bool> > flag) : flag_(std::move(flag)) {}
+
+		bool cancelled() const { return flag_ && flag_->load(std::memory_order_acquire); }
+
+		bool cancellable() const { return flag_ != nullptr; }
+
+	private:
+		std::shared_ptr<const std::atomic<bool> > flag_;
+	};
+
+	// Token of the scoped work running on this thread. HTTP transfers and UI
+	// posts made several calls down pick it up from here instead of having
+	// it passed through every signature.
+	inline CancelToken &currentToken() {
+		thread_local CancelToken token;
+		return token;
+	}
+
+	inline bool cancelled() {
+		return currentToken().cancelled();
+	}
+
+	// Makes `token` current until the end of the enclosing block.
+	class WithToken {
+	public:
+		explicit WithToken(CancelToken token) : previous_(std::exchange(currentToken(), std::move(token))) {}
+
+		~WithToken() { currentToken() = std::move(previous_); }
+
+		WithToken(const WithToken &) = delete;
+		WithToken &operator=(const WithToken &) = delete;
+
+	private:
+		CancelToken previous_;
+	};
+
+	struct TaskStats {
+		std::string name;
+		uint64_t runs = 0;
+		uint64_t failures = 0; // threw
+		double runMs = 0;      // summed
+		double maxWaitMs = 0;  // longest time queued before a worker took it
+	};
+
+	// Fixed set of workers, one deque per worker and priority. Work
+	// submitted from a worker goes on its own deque and is taken LIFO; idle
+	// workers steal from the front of the others'. Interactive work is
+	// always taken first, and background work may occupy every worker but
+	// one, so a flood of thumbnail loads can't hold up a button click.
+	class Pool {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static Pool &instance() {
+			// Never destroyed: like the detached threads this replaces, tasks
+			// still running at exit are simply ended with the process.
+			static Pool *pool = new Pool();
+			return *pool;
+		}
+
+		void submit(const char *name, Priority priority, std::function<void()> fn) {
+			size_t p = static_cast<size_t>(priority);
+			size_t index = currentWorker() >= 0
+				               ? static_cast<size_t>(currentWorker())
+				               : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+			{
+				std::lock_guard<std::mutex> lock(workers_[index]->mtx);
+				workers_[index]->queues[p].push_back(Task{name, priority, std::move(fn), Clock::now()});
+			}
+			queued_[p].fetch_add(1, std::memory_order_release);
+			wake();
+		}
+
+		// Runs queued tasks on the calling worker until `ready` holds, so a
+		// task waiting on another task's result can't tie up the pool. From
+		// any other thread this just polls.
+		template<typename Ready>
+		void helpUntil(Ready &&ready) {
+			int self = currentWorker();
+			while (!ready()) {
+				Task task;
+				if (self >= 0 && tryTake(static_cast<size_t>(self), task))
+					run(task);
+				else
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		}
+
+		// Starts a thread that serves the calling worker's queues while the
+		// worker sleeps; see Threading::Blocking. A sleeping background task
+		// also gives back its background slot meanwhile. Returns null off the
+		// pool, on a stand-in (they never stand in for each other) and once
+		// there are as many stand-ins as workers, so a server answering
+		// everything with Retry-After can at most double the thread count.
+		std::shared_ptr<std::atomic<bool> > startStandIn() {
+			int self = currentWorker();
+			if (self < 0 || isStandIn())
+				return nullptr;
+			size_t live = standIns_.load(std::memory_order_relaxed);
+			do {
+				if (live >= workers_.size())
+					return nullptr;
+			} while (!standIns_.compare_exchange_weak(live, live + 1, std::memory_order_relaxed));
+			auto done = std::make_shared<std::atomic<bool> >(false);
+			if (currentPriority() == Priority::Background)
+				runningBackground_.fetch_sub(1, std::memory_order_acq_rel);
+			std::thread([this, self, done] {
+				standInLoop(self, *done);
+				standIns_.fetch_sub(1, std::memory_order_relaxed);
+			}).detach();
+			return done;
+		}
+
+		// The stand-in finishes the task it is running, if any, then exits.
+		void stopStandIn(const std::shared_ptr<std::atomic<bool> > &done) {
+			if (currentPriority() == Priority::Background)
+				runningBackground_.fetch_add(1, std::memory_order_acq_rel);
+			done->store(true, std::memory_order_release);
+			{ std::lock_guard<std::mutex> lock(sleepMtx_); }
+			cv_.notify_all();
+		}
+
+		size_t workerCount() const { return workers_.size(); }
+
+		size_t standIns() const { return standIns_.load(std::memory_order_relaxed); }
+
+		size_t queued() const {
+			return queued_[0].load(std::memory_order_relaxed) + queued_[1].load(std::memory_order_relaxed);
+		}
+
+		std::vector<TaskStats> stats() const {
+			std::lock_guard<std::mutex> lock(statsMtx_);
+			std::vector<TaskStats> out;
+			for (const auto &[name, s]: stats_)
+				out.push_back(s);
+			std::sort(out.begin(), out.end(), [](const TaskStats &a, const TaskStats &b) { return a.runMs > b.runMs; });
+			return out;
+		}
+
+	private:
+		struct Task {
+			const char *name = "";
+			Priority priority = Priority::Background;
+			std::function<void()> fn;
+			Clock::time_point queuedAt;
+		};
+
+		struct Worker {
+			std::mutex mtx;
+			std::deque<Task> queues[2];
+		};
+
+		Pool() {
+			unsigned n = std::clamp(std::thread::hardware_concurrency(), 4u, 16u);
+			backgroundLimit_ = static_cast<int>(n) - 1;
+			for (unsigned i = 0; i < n; ++i)
+				workers_.push_back(std::make_unique<Worker>());
+			for (unsigned i = 0; i < n; ++i)
+				std::thread([this, i] { workerLoop(static_cast<int>(i)); }).detach();
+		}
+
+		static int &currentWorkerSlot() {
+			thread_local int index = -1;
+			return index;
+		}
+
+		static int currentWorker() { return currentWorkerSlot(); }
+
+		static bool &isStandIn() {
+			thread_local bool standIn = false;
+			return standIn;
+		}
+
+		// Priority of the task running on this thread; Interactive outside one.
+		static Priority &currentPriority() {
+			thread_local Priority priority = Priority::Interactive;
+			return priority;
+		}
+
+		void wake() {
+			{ std::lock_guard<std::mutex> lock(sleepMtx_); }
+			cv_.notify_one();
+		}
+
+		bool runnable() const {
+			return queued_[0].load(std::memory_order_acquire) > 0 ||
+			       (queued_[1].load(std::memory_order_acquire) > 0 &&
+			        runningBackground_.load(std::memory_order_acquire) < backgroundLimit_);
+		}
+
+		bool takeFrom(size_t index, size_t p, bool own, Task &out) {
+			std::lock_guard<std::mutex> lock(workers_[index]->mtx);
+			auto &q = workers_[index]->queues[p];
+			if (q.empty())
+				return false;
+			if (own) {
+				out = std::move(q.back());
+				q.pop_back();
+			} else {
+				out = std::move(q.front());
+				q.pop_front();
+			}
+			queued_[p].fetch_sub(1, std::memory_order_acq_rel);
+			return true;
+		}
+
+		bool takeAny(size_t self, size_t p, Task &out) {
+			if (queued_[p].load(std::memory_order_acquire) == 0)
+				return false;
+			if (takeFrom(self, p, true, out))
+				return true;
+			for (size_t i = 1; i < workers_.size(); ++i) {
+				if (takeFrom((self + i) % workers_.size(), p, false, out))
+					return true;
+			}
+			return false;
+		}
+
+		bool tryTake(size_t self, Task &out) {
+			if (takeAny(self, 0, out))
+				return true;
+			// Reserve a background slot before looking so the limit holds
+			// even when several workers go for background work at once.
+			int running = runningBackground_.load(std::memory_order_acquire);
+			do {
+				if (running >= backgroundLimit_)
+					return false;
+			} while (!runningBackground_.compare_exchange_weak(running, running + 1, std::memory_order_acq_rel));
+			if (takeAny(self, 1, out))
+				return true;
+			runningBackground_.fetch_sub(1, std::memory_order_acq_rel);
+			return false;
+		}
+
+		void run(Task &task) {
+			auto started = Clock::now();
+			bool failed = false;
+			{
+				// helpUntil can run this inside another task; don't let it
+				// inherit that task's token.
+				WithToken unscoped{CancelToken{}};
+				Priority outer = std::exchange(currentPriority(), task.priority);
+				try {
+					task.fn();
+				} catch (const std::exception &e) {
+					failed = true;
+					LOG_ERROR(std::string("Task ") + task.name + " threw: " + e.what());
+				} catch (...) {
+					failed = true;
+					LOG_ERROR(std::string("Task ") + task.name + " threw a non-standard exception");
+				}
+				currentPriority() = outer;
+			}
+			auto finished = Clock::now();
+			if (task.priority == Priority::Background) {
+				runningBackground_.fetch_sub(1, std::memory_order_acq_rel);
+				wake(); // a background task may have been waiting for the slot
+			}
+
+			std::lock_guard<std::mutex> lock(statsMtx_);
+			auto &s = stats_[task.name];
+			s.name = task.name;
+			++s.runs;
+			if (failed)
+				++s.failures;
+			s.runMs += std::chrono::duration<double, std::milli>(finished - started).count();
+			s.maxWaitMs = std::max(s.maxWaitMs,
+			                       std::chrono::duration<double, std::milli>(started - task.queuedAt).count());
+		}
+
+		void workerLoop(int index) {
+			currentWorkerSlot() = index;
+			while (true) {
+				Task task;
+				if (tryTake(static_cast<size_t>(index), task)) {
+					run(task);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(sleepMtx_);
+				cv_.wait(lock, [this] { return runnable(); });
+			}
+		}
+
+		void standInLoop(int index, const std::atomic<bool> &done) {
+			currentWorkerSlot() = index;
+			isStandIn() = true;
+			while (!done.load(std::memory_order_acquire)) {
+				Task task;
+				if (tryTake(static_cast<size_t>(index), task)) {
+					run(task);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(sleepMtx_);
+				cv_.wait(lock, [&] { return runnable() || done.load(std::memory_order_acquire); });
+			}
+			// The wake-up that ended the wait may have been meant for a worker.
+			if (runnable())
+				wake();
+		}
+
+		std::vector<std::unique_ptr<Worker> > workers_;
+		std::atomic<size_t> standIns_{0};
+		std::atomic<size_t> queued_[2]{};
+		std::atomic<int> runningBackground_{0};
+		int backgroundLimit_ = 1;
+		std::atomic<size_t> nextWorker_{0};
+		std::mutex sleepMtx_;
+		std::condition_variable cv_;
+		mutable std::mutex statsMtx_;
+		std::map<std::string, TaskStats> stats_;
+	};
+
+	// Queues f(args...) on the shared pool. `name` labels the task in
+	// Pool::stats() and must be a string literal.
+	template<typename Func, typename... Args>
+	void submit(const char *name, Priority priority, Func &&f, Args &&... args) {
+		Pool::instance().submit(
+			name, priority,
+			[fn = std::forward<Func>(f), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+				std::apply(fn, tup);
+			});
+	}
+
+	template<typename Func, typename... Args>
+	void interactive(const char *name, Func &&f, Args &&... args) {
+		submit(name, Priority::Interactive, std::forward<Func>(f), std::forward<Args>(args)...);
+	}
+
+	template<typename Func, typename... Args>
+	void background(const char *name, Func &&f, Args &&... args) {
+		submit(name, Priority::Background, std::forward<Func>(f), std::forward<Args>(args)...);
+	}
+
+	// Marks a stretch where the calling thread sleeps instead of working, such
+	// as a Retry-After pause. On a pool worker a stand-in thread serves its
+	// queues until the scope ends, so the pool keeps its width. Unlike
+	// helpUntil it never runs other tasks on this stack, so it is safe where
+	// those tasks could wait on the caller. Off the pool it does nothing.
+	class Blocking {
+	public:
+		Blocking() : done_(Pool::instance().startStandIn()) {}
+
+		~Blocking() {
+			if (done_)
+				Pool::instance().stopStandIn(done_);
+		}
+
+		Blocking(const Blocking &) = delete;
+		Blocking &operator=(const Blocking &) = delete;
+
+	private:
+		std::shared_ptr<std::atomic<bool> > done_;
+	};
+
+	// Waits for a future; on a pool worker, runs other tasks meanwhile.
+	template<typename Future>
+	void wait(const Future &future) {
+		Pool::instance().helpUntil([&] {
+			return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+	}
+
+	inline std::string describePool() {
+		auto &pool = Pool::instance();
+		char buf[160];
+		snprintf(buf, sizeof(buf), "%zu workers (%zu stand-ins), %zu queued", pool.workerCount(), pool.standIns(),
+		         pool.queued());
+		std::string out = buf;
+		auto all = pool.stats();
+		for (size_t i = 0; i < all.size() && i < 6; ++i) {
+			const auto &s = all[i];
+			snprintf(buf, sizeof(buf), "; %s %llu runs %.0f ms (max wait %.0f ms%s)", s.name.c_str(),
+			         static_cast<unsigned long long>(s.runs), s.runMs, s.maxWaitMs,
+			         s.failures ? ", threw" : "");
+			out += buf;
+		}
+		return out;
+	}
+
+	// A dedicated, detached thread, for work that runs for the life of the
+	// app or sits in its own message loop and so would hold a pool worker
+	// forever.
 	template<typename Func, typename... Args>
 	void newThread(Func &&f, Args &&... args) {
 		std::thread(
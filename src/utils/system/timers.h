@@ -0,0 +1,225 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "threading.h"
+
+namespace Timers {
+	using Clock = std::chrono::steady_clock;
+	using Id = uint64_t; // 0 is never a live timer
+
+	// One thread for every delayed and periodic job in the app. Timers hash
+	// into kSlots buckets by their due tick; a bucket holds every timer due
+	// on that tick in any turn of the wheel, so adding and cancelling are
+	// O(1) however far out the timer is. The thread sleeps until the next
+	// non-empty bucket rather than waking every tick. Callbacks are handed
+	// to the thread pool under the timer's name, never run on the wheel's
+	// own thread, so a slow one can't hold up the others.
+	class Wheel {
+	public:
+		static constexpr auto kTick = std::chrono::milliseconds(50);
+		static constexpr size_t kSlots = 512; // one turn is about 25 s
+
+		static Wheel &instance() {
+			// Never destroyed, for the same reason as Threading::Pool.
+			static Wheel *wheel = new Wheel();
+			return *wheel;
+		}
+
+		// `period` of zero makes a one-shot timer. Periodic timers keep a
+		// fixed rate and skip runs they missed rather than bunching up.
+		Id schedule(const char *name, Clock::time_point at, Clock::duration period, Threading::Priority priority,
+		            std::function<void()> fn) {
+			Id id;
+			{
+				std::lock_guard<std::mutex> lock(mtx_);
+				id = nextId_++;
+				insertLocked(Entry{
+					id, name, tickFor(at), ticksIn(period), priority,
+					std::make_shared<std::function<void()> >(std::move(fn))
+				});
+			}
+			cv_.notify_one();
+			return id;
+		}
+
+		// False if the timer already fired (one-shot) or never existed. A
+		// callback already handed to the pool still runs.
+		bool cancel(Id id) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = slotOf_.find(id);
+			if (it == slotOf_.end())
+				return false;
+			auto &slot = slots_[it->second];
+			slot.erase(std::find_if(slot.begin(), slot.end(), [id](const Entry &e) { return e.id == id; }));
+			slotOf_.erase(it);
+			return true;
+		}
+
+		size_t active() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return slotOf_.size();
+		}
+
+		std::string describe() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			std::map<std::string, size_t> byName;
+			for (const auto &slot: slots_) {
+				for (const auto &e: slot)
+					++byName[e.name];
+			}
+			char buf[96];
+			snprintf(buf, sizeof(buf), "%zu active, %llu fired", slotOf_.size(),
+			         static_cast<unsigned long long>(fired_));
+			std::string out = buf;
+			for (const auto &[name, count]: byName) {
+				out += "; " + name;
+				if (count > 1)
+					out += " x" + std::to_string(count);
+			}
+			return out;
+		}
+
+	private:
+		struct Entry {
+			Id id = 0;
+			const char *name = "";
+			uint64_t due = 0;    // tick number
+			uint64_t period = 0; // ticks, 0 = one-shot
+			Threading::Priority priority = Threading::Priority::Background;
+			std::shared_ptr<std::function<void()> > fn;
+		};
+
+		Wheel() : epoch_(Clock::now()) {
+			std::thread([this] { run(); }).detach();
+		}
+
+		static uint64_t ticksIn(Clock::duration d) {
+			if (d <= Clock::duration::zero())
+				return 0;
+			return std::max<uint64_t>(1, static_cast<uint64_t>((d + kTick - Clock::duration(1)) / kTick));
+		}
+
+		// First tick at or after `at` that hasn't been processed yet.
+		uint64_t tickFor(Clock::time_point at) const {
+			uint64_t tick = at > epoch_ ? ticksIn(at - epoch_) : 0;
+			return std::max(tick, processed_ + 1);
+		}
+
+		void insertLocked(Entry e) {
+			size_t slot = static_cast<size_t>(e.due % kSlots);
+			slotOf_[e.id] = slot;
+			slots_[slot].push_back(std::move(e));
+		}
+
+		// Pulls everything due by `now` out of the buckets for ticks
+		// (processed_, now], re-inserting periodic timers.
+		void collectLocked(uint64_t now, std::vector<Entry> &fire) {
+			uint64_t visits = std::min<uint64_t>(now - processed_, kSlots);
+			for (uint64_t i = 1; i <= visits; ++i) {
+				auto &slot = slots_[static_cast<size_t>((processed_ + i) % kSlots)];
+				for (size_t j = 0; j < slot.size();) {
+					if (slot[j].due > now) {
+						++j;
+						continue;
+					}
+					fire.push_back(slot[j]);
+					slot[j] = std::move(slot.back());
+					slot.pop_back();
+				}
+			}
+			processed_ = now;
+			for (auto &e: fire) {
+				slotOf_.erase(e.id);
+				if (e.period == 0)
+					continue;
+				Entry next = e;
+				next.due += ((now - e.due) / e.period + 1) * e.period;
+				insertLocked(std::move(next));
+			}
+			fired_ += fire.size();
+		}
+
+		// Tick of the first bucket with anything in it; entries there may
+		// belong to a later turn, in which case the thread just looks again.
+		uint64_t nextBusyTickLocked() const {
+			for (uint64_t t = processed_ + 1; t <= processed_ + kSlots; ++t) {
+				if (!slots_[static_cast<size_t>(t % kSlots)].empty())
+					return t;
+			}
+			return 0;
+		}
+
+		void run() {
+			std::unique_lock<std::mutex> lock(mtx_);
+			while (true) {
+				auto now = static_cast<uint64_t>((Clock::now() - epoch_) / kTick);
+				if (now > processed_) {
+					std::vector<Entry> fire;
+					collectLocked(now, fire);
+					if (!fire.empty()) {
+						lock.unlock();
+						for (auto &e: fire)
+							Threading::Pool::instance().submit(e.name, e.priority, [fn = e.fn] { (*fn)(); });
+						lock.lock();
+						continue;
+					}
+				}
+				if (uint64_t next = nextBusyTickLocked())
+					cv_.wait_until(lock, epoch_ + next * kTick);
+				else
+					cv_.wait(lock);
+			}
+		}
+
+		const Clock::time_point epoch_;
+		mutable std::mutex mtx_;
+		std::condition_variable cv_;
+		std::vector<Entry> slots_[kSlots];
+		std::unordered_map<Id, size_t> slotOf_; // live timers -> bucket
+		uint64_t processed_ = 0;                // last tick whose bucket was handled
+		uint64_t fired_ = 0;
+		Id nextId_ = 1;
+	};
+
+	// `name` labels the timer in describe() and the pool's task stats and
+	// must be a string literal.
+	inline Id at(const char *name, Clock::time_point when, std::function<void()> fn,
+	             Threading::Priority priority = Threading::Priority::Background) {
+		return Wheel::instance().schedule(name, when, Clock::duration::zero(), priority, std::move(fn));
+	}
+
+	inline Id after(const char *name, Clock::duration delay, std::function<void()> fn,
+	                Threading::Priority priority = Threading::Priority::Background) {
+		return at(name, Clock::now() + delay, std::move(fn), priority);
+	}
+
+	// First run is one period from now.
+	inline Id every(const char *name, Clock::duration period, std::function<void()> fn,
+	                Threading::Priority priority = Threading::Priority::Background) {
+		return Wheel::instance().schedule(name, Clock::now() + period, period, priority, std::move(fn));
+	}
+
+	inline bool cancel(Id id) {
+		return id != 0 && Wheel::instance().cancel(id);
+	}
+
+	inline size_t active() {
+		return Wheel::instance().active();
+	}
+
+	inline std::string describe() {
+		return Wheel::instance().describe();
+	}
+}
@@ -10,7 +10,7 @@
 #include "../../version.h"
 
 inline void CheckForUpdates() {
-	Threading::newThread([]() {
+	Threading::background("update.check", []() {
 		const std::string url = "https://api.github.com/repos/crowsyndrome/altman/releases/latest";
 		auto resp = HttpClient::get(url, {{"User-Agent", "AltMan"}, {"Accept", "application/vnd.github+json"}});
 		if (resp.status_code != 200) {
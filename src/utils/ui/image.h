@@ -18,7 +18,7 @@ inline bool LoadImageFromUrl(const std::string &url,
                              int *out_width,
                              int *out_height)
 {
-    auto resp = HttpClient::get(url);
+    auto resp = HttpClient::download(url);
     if (resp.status_code != 200 || resp.text.empty())
         return false;
     return LoadTextureFromMemory(resp.text.data(), resp.text.size(), out_srv, out_width, out_height);